@@ -0,0 +1,119 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/json.hpp"
+#include <fstream>
+#include <sstream>
+
+// Enumerations w. Name Tables
+
+enum class level { DEBUG, INFO, WARN, ERROR };
+enum class mode: char { FAST = 'f', SAFE = 's' };
+enum sink { CONSOLE = 1, LOGFILE = 2, SYSLOG = 4 };
+
+template<>
+struct ctom::rule<level> {
+	typedef ctom::enum_map<level,
+		ctom::entry<"debug", level::DEBUG>,
+		ctom::entry<"info", level::INFO>,
+		ctom::entry<"warn", level::WARN>,
+		ctom::entry<"error", level::ERROR>
+	> type;
+};
+
+template<>
+struct ctom::rule<mode> {
+	typedef ctom::enum_map<mode,
+		ctom::entry<"fast", mode::FAST>,
+		ctom::entry<"safe", mode::SAFE>
+	> type;
+};
+
+template<>
+struct ctom::rule<sink> {
+	typedef ctom::enum_map<sink,
+		ctom::entry<"console", CONSOLE>,
+		ctom::entry<"file", LOGFILE>,
+		ctom::entry<"syslog", SYSLOG>
+	> type;
+};
+
+// Object-Model w. Enum Values
+
+using Service = ctom::obj<
+	ctom::key<"level", level>,
+	ctom::key<"mode", mode>,
+	ctom::key<"sinks", ctom::arr<3, sink>>
+>;
+
+struct Sinks_Impl: ctom::arr<3, sink> {
+	sink s[3] = {CONSOLE, CONSOLE, CONSOLE};
+	Sinks_Impl(){
+		this->val<0>() = s[0];
+		this->val<1>() = s[1];
+		this->val<2>() = s[2];
+	}
+};
+
+struct Service_Impl: Service {
+	level l = level::INFO;
+	mode m = mode::FAST;
+	Sinks_Impl sinks;
+	Service_Impl(){
+		this->val<"level">() = l;
+		this->val<"mode">() = m;
+		this->val<"sinks">() = sinks;
+	}
+};
+
+int main( int argc, char* args[] ) {
+
+	ctom::print<Service>();
+
+	Service_Impl service;
+
+	std::ifstream yaml_file("config.yaml");
+	if(yaml_file.is_open()){
+
+		try {
+			yaml_file >> ctom::yaml::parse >> service;
+			std::cout << ctom::yaml::emit << service;
+		} catch(ctom::exception e){
+			std::cout<<"Failed to parse config.yaml: "<<e.what()<<std::endl;
+		}
+
+		yaml_file.close();
+
+	}
+
+	std::ifstream json_file("config.json");
+	if(json_file.is_open()){
+
+		try {
+			json_file >> ctom::json::parse >> service;
+			std::cout << ctom::json::emit << service;
+		} catch(ctom::exception e){
+			std::cout<<"Failed to parse config.json: "<<e.what()<<std::endl;
+		}
+
+		json_file.close();
+
+	}
+
+	// Unnamed values are written as integers
+
+	service.sinks.s[2] = (sink)(CONSOLE | LOGFILE);
+	std::cout << ctom::json::emit(ctom::COMPACT) << service;
+	std::cout << std::endl;
+
+	// Unknown names fail with the offending line
+
+	std::stringstream bad("level: verbose\n");
+	try {
+		bad >> ctom::yaml::parse >> service;
+	} catch(ctom::exception e){
+		std::cout<<"Failed to parse: "<<e.what()<<std::endl;
+	}
+
+	return 0;
+
+}
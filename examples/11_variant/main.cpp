@@ -0,0 +1,115 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/json.hpp"
+#include <fstream>
+#include <variant>
+
+// Event Alternatives w. Object Rules
+
+struct login {
+	std::string user;
+	std::string address;
+};
+
+struct logout {
+	std::string user;
+};
+
+struct transfer {
+	std::string from;
+	std::string to;
+	double amount = 0.0;
+};
+
+using login_t = ctom::obj<
+	ctom::key<"user", std::string>,
+	ctom::key<"address", std::string>
+>;
+
+struct login_p: login_t {
+	login_p(login& l):login_t(l.user, l.address){};
+};
+
+using logout_t = ctom::obj<
+	ctom::key<"user", std::string>
+>;
+
+struct logout_p: logout_t {
+	logout_p(logout& l):logout_t(l.user){};
+};
+
+using transfer_t = ctom::obj<
+	ctom::key<"from", std::string>,
+	ctom::key<"to", std::string>,
+	ctom::key<"amount", double>
+>;
+
+struct transfer_p: transfer_t {
+	transfer_p(transfer& t):transfer_t(t.from, t.to, t.amount){};
+};
+
+template<> struct ctom::rule<login> { typedef login_p type; };
+template<> struct ctom::rule<logout> { typedef logout_p type; };
+template<> struct ctom::rule<transfer> { typedef transfer_p type; };
+
+// Tagged Union: the "type" key selects the alternative
+
+using event = std::variant<login, logout, transfer>;
+
+template<>
+struct ctom::rule<event> {
+	typedef ctom::tagged<event, "type",
+		ctom::alt<"login", login>,
+		ctom::alt<"logout", logout>,
+		ctom::alt<"transfer", transfer>
+	> type;
+};
+
+// Fixed-Size Event Batch
+
+template<typename T>
+struct batch_p: ctom::arr<3, T>{
+	batch_p(T (&e)[3])
+	:ctom::arr<3, T>(e[0], e[1], e[2]){};
+};
+
+int main( int argc, char* args[] ) {
+
+	ctom::print<ctom::arr<3, event>>();
+
+	event events[3];
+	batch_p<event> batch(events);
+
+	std::ifstream yaml_file("events.yaml");
+	if(yaml_file.is_open()){
+
+		try {
+			yaml_file >> ctom::yaml::parse >> batch;
+			std::cout << ctom::yaml::emit << batch;
+		} catch(ctom::exception e){
+			std::cout<<"Failed to parse events.yaml: "<<e.what()<<std::endl;
+		}
+
+		yaml_file.close();
+
+	}
+
+	std::ifstream json_file("events.json");
+	if(json_file.is_open()){
+
+		try {
+			json_file >> ctom::json::parse >> batch;
+			std::cout << ctom::json::emit << batch;
+		} catch(ctom::exception e){
+			std::cout<<"Failed to parse events.json: "<<e.what()<<std::endl;
+		}
+
+		json_file.close();
+
+	}
+
+	std::cout << ctom::yaml::emit(ctom::COMPACT) << batch;
+
+	return 0;
+
+}
@@ -0,0 +1,113 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/json.hpp"
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+// Well-Known Types w. Rules
+
+template<typename T>
+struct vec3 {
+	T x;
+	T y;
+	T z;
+};
+
+template<typename T>
+struct vec3_p: ctom::arr<3, T>{
+	vec3_p(vec3<T>& vec)
+	:ctom::arr<3, T>(vec.x, vec.y, vec.z){};
+};
+
+template<typename T>
+struct ctom::rule<vec3<T>>{
+	typedef vec3_p<T> type;
+};
+
+struct record {
+	std::string name;
+	int count = 0;
+	vec3<float> pos;
+	std::vector<int> tags;
+};
+
+using record_t = ctom::obj<
+	ctom::key<"name", std::string>,
+	ctom::key<"count", int>,
+	ctom::key<"pos", vec3<float>>,
+	ctom::key<"tags", std::vector<int>>
+>;
+
+struct record_p: record_t {
+	record_p(record& r)
+	:record_t(r.name, r.count, r.pos, r.tags){};
+};
+
+template<>
+struct ctom::rule<record> {
+	typedef record_p type;
+};
+
+int main( int argc, char* args[] ) {
+
+	ctom::print<record_t>();
+
+	// Sequence: every element is parsed in place,
+	//	through one element schema rebound from slot to slot
+
+	std::vector<record> records;
+
+	std::ifstream yaml_file("records.yaml");
+	if(yaml_file.is_open()){
+
+		try {
+			yaml_file >> ctom::yaml::parse >> records;
+			std::cout << ctom::yaml::emit << records;
+		} catch(ctom::exception e){
+			std::cout<<"Failed to parse records.yaml: "<<e.what()<<std::endl;
+		}
+
+		yaml_file.close();
+
+	}
+
+	// Existing slots are reused, the sequence is trimmed to the document
+
+	std::ifstream json_file("records.json");
+	if(json_file.is_open()){
+
+		try {
+			json_file >> ctom::json::parse >> records;
+			std::cout << ctom::json::emit << records;
+		} catch(ctom::exception e){
+			std::cout<<"Failed to parse records.json: "<<e.what()<<std::endl;
+		}
+
+		json_file.close();
+
+	}
+
+	// Rebindable Schema: built once, moved from record to record
+
+	const char* docs[3] = {
+		"{\"name\": \"one\", \"count\": 1, \"pos\": [1, 0, 0], \"tags\": [1]}",
+		"{\"name\": \"two\", \"count\": 2, \"pos\": [0, 2, 0], \"tags\": [2, 2]}",
+		"{\"name\": \"three\", \"count\": 3, \"pos\": [0, 0, 3], \"tags\": [3, 3, 3]}"
+	};
+
+	record batch[3];
+	ctom::schema<record> schema(batch[0]);
+
+	for(size_t n = 0; n < 3; n++){
+		std::istringstream in(docs[n]);
+		schema.rebind(batch[n]);
+		in >> ctom::json::parse >> schema;
+	}
+
+	for(auto& r: batch)
+		std::cout << ctom::yaml::emit(ctom::COMPACT) << r;
+
+	return 0;
+
+}
@@ -0,0 +1,123 @@
+#include "../../src/ctom.hpp"
+#include "../../src/prom.hpp"
+#include <atomic>
+#include <map>
+#include <vector>
+
+// Service Counters in Plain Structs
+
+enum class state { IDLE, BUSY, DRAINING };
+
+struct worker {
+	std::atomic<long> jobs{0};
+	std::atomic<bool> busy{false};
+	double load = 0.0;
+};
+
+struct route {
+	long hits = 0;
+	double latency = 0.0;
+};
+
+struct service {
+	std::string name = "frontend";		// not a sample: skipped
+	std::atomic<long> requests{0};
+	state status = state::IDLE;
+	worker workers[2];
+	std::map<std::string, route> routes;
+	std::vector<double> queue_depth;
+};
+
+// Rules
+
+using worker_t = ctom::obj<
+	ctom::key<"jobs_total", std::atomic<long>>,
+	ctom::key<"busy", std::atomic<bool>>,
+	ctom::key<"load", double>
+>;
+
+struct worker_p: worker_t {
+	worker_p(worker& w):worker_t(w.jobs, w.busy, w.load){};
+};
+
+template<> struct ctom::rule<worker> { typedef worker_p type; };
+
+using route_t = ctom::obj<
+	ctom::key<"hits_total", long>,
+	ctom::key<"latency-seconds", double>
+>;
+
+struct route_p: route_t {
+	route_p(route& r):route_t(r.hits, r.latency){};
+};
+
+template<> struct ctom::rule<route> { typedef route_p type; };
+
+template<typename T>
+struct pair_p: ctom::arr<2, T>{
+	pair_p(T (&t)[2]):ctom::arr<2, T>(t[0], t[1]){};
+};
+
+template<> struct ctom::rule<worker[2]> { typedef pair_p<worker> type; };
+
+using service_t = ctom::obj<
+	ctom::key<"name", std::string>,
+	ctom::key<"requests_total", std::atomic<long>>,
+	ctom::key<"status", state>,
+	ctom::key<"worker", worker[2]>,
+	ctom::key<"route", std::map<std::string, route>>,
+	ctom::key<"queue_depth", std::vector<double>>
+>;
+
+struct service_p: service_t {
+	service_p(service& s)
+	:service_t(s.name, s.requests, s.status, s.workers, s.routes, s.queue_depth){};
+};
+
+template<> struct ctom::rule<service> { typedef service_p type; };
+
+// Metrics Root: the namespace of all metric names
+
+struct metrics {
+	service app;
+};
+
+using metrics_t = ctom::obj<
+	ctom::key<"app", service>
+>;
+
+struct metrics_p: metrics_t {
+	metrics_p(metrics& m):metrics_t(m.app){};
+};
+
+template<> struct ctom::rule<metrics> { typedef metrics_p type; };
+
+int main( int argc, char* args[] ) {
+
+	metrics m;
+	metrics_p scrape(m);	// bound once, emitted on every scrape
+
+	m.app.requests = 1024;
+	m.app.status = state::BUSY;
+	m.app.workers[0].jobs = 700;
+	m.app.workers[0].busy = true;
+	m.app.workers[0].load = 0.75;
+	m.app.workers[1].jobs = 324;
+	m.app.workers[1].load = 0.125;
+	m.app.routes["/api"] = {900, 0.012};
+	m.app.routes["/static \"v2\""] = {124, 0.5};
+	m.app.queue_depth = {3, 1.5, 1.0/0.0};
+
+	std::cout << ctom::prom::emit << scrape;
+
+	// Counters move, the next scrape reuses all storage
+
+	m.app.requests += 16;
+	m.app.workers[1].busy = true;
+	m.app.queue_depth.pop_back();
+
+	std::cout << ctom::prom::emit << scrape;
+
+	return 0;
+
+}
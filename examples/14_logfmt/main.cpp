@@ -0,0 +1,104 @@
+#include "../../src/ctom.hpp"
+#include "../../src/logfmt.hpp"
+#include <chrono>
+#include <vector>
+
+// Request Event
+
+enum class method { GET, POST, PUT, DELETE };
+
+template<>
+struct ctom::rule<method> {
+	typedef ctom::enum_map<method,
+		ctom::entry<"GET", method::GET>,
+		ctom::entry<"POST", method::POST>,
+		ctom::entry<"PUT", method::PUT>,
+		ctom::entry<"DELETE", method::DELETE>
+	> type;
+};
+
+struct timing {
+	double queue = 0.0;
+	double total = 0.0;
+};
+
+struct request {
+	method verb = method::GET;
+	std::string_view path;
+	int status = 200;
+	bool cached = false;
+	timing time;
+	std::vector<std::string_view> tags;
+	std::string_view agent;
+};
+
+using timing_t = ctom::obj<
+	ctom::key<"queue", double>,
+	ctom::key<"total", double>
+>;
+
+struct timing_p: timing_t {
+	timing_p(timing& t):timing_t(t.queue, t.total){};
+};
+
+template<> struct ctom::rule<timing> { typedef timing_p type; };
+
+using request_t = ctom::obj<
+	ctom::key<"method", method>,
+	ctom::key<"path", std::string_view>,
+	ctom::key<"status", int>,
+	ctom::key<"cached", bool>,
+	ctom::key<"time", timing>,
+	ctom::key<"tags", std::vector<std::string_view>>,
+	ctom::key<"user agent", std::string_view>
+>;
+
+struct request_p: request_t {
+	request_p(request& r)
+	:request_t(r.verb, r.path, r.status, r.cached, r.time, r.tags, r.agent){};
+};
+
+template<> struct ctom::rule<request> { typedef request_p type; };
+
+int main( int argc, char* args[] ) {
+
+	request r;
+	r.verb = method::POST;
+	r.path = "/api/orders";
+	r.status = 201;
+	r.time = {0.000125, 0.0042};
+	r.tags = {"edge", "eu-west"};
+	r.agent = "curl/8.1 \"test\"";
+
+	request_p event(r);		// bound once, logged per event
+
+	std::cout << ctom::logfmt::emit << event;
+
+	// Custom Sink
+
+	size_t bytes = 0;
+	auto sink = [&bytes](std::string_view line){
+		bytes += line.size();
+	};
+
+	r.status = 404;
+	r.cached = true;
+	ctom::logfmt::log([](std::string_view line){
+		std::cout.write(line.data(), line.size());
+	}, event);
+
+	// Hot-Path Cost per Event
+
+	const size_t N = 200000;
+	auto t0 = std::chrono::steady_clock::now();
+	for(size_t n = 0; n < N; n++){
+		r.status = 200 + n % 300;
+		ctom::logfmt::log(sink, event);
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+	std::cout << "logged " << N << " events (" << bytes << " bytes), " << ns << " ns/event\n";
+
+	return 0;
+
+}
@@ -0,0 +1,82 @@
+#include "../../src/ctom.hpp"
+#include "../../src/json.hpp"
+#include "../../src/frame.hpp"
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+
+// Record Type w. Rule
+
+struct sample {
+	int id = 0;
+	std::string source;
+	std::vector<double> values;
+};
+
+using sample_t = ctom::obj<
+	ctom::key<"id", int>,
+	ctom::key<"source", std::string>,
+	ctom::key<"values", std::vector<double>>
+>;
+
+struct sample_p: sample_t {
+	sample_p(sample& s):sample_t(s.id, s.source, s.values){};
+};
+
+template<> struct ctom::rule<sample> { typedef sample_p type; };
+
+int main( int argc, char* args[] ) {
+
+	int fds[2];
+	if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0){
+		std::cout<<"Failed to create socketpair"<<std::endl;
+		return 1;
+	}
+
+	const int N = 20000;
+
+	// Producer: one schema, rebound per record, frames written in batches
+
+	std::thread producer([&](){
+		ctom::frame::writer out(fds[0]);
+		sample s;
+		ctom::schema<sample> schema(s);
+		for(int n = 0; n < N; n++){
+			s.id = n;
+			s.source = (n % 2 == 0) ? "sensor-a" : "sensor \"b\"";
+			s.values.assign({n * 0.5, n * 0.25});
+			out.put(schema);
+		}
+		out.flush();
+		close(fds[0]);
+	});
+
+	// Consumer: frames parsed in place from the receive buffer
+
+	ctom::frame::reader in(fds[1]);
+	sample s;
+	ctom::schema<sample> schema(s);
+
+	long checksum = 0;
+	size_t bad = 0;
+	try {
+		while(in.next(schema)){
+			checksum += s.id;
+			if(s.values.size() != 2 || s.values[0] != s.id * 0.5)
+				bad++;
+			if(s.source != ((s.id % 2 == 0) ? "sensor-a" : "sensor \"b\""))
+				bad++;
+		}
+	} catch(std::exception& e){
+		std::cout<<"Failed to read frames: "<<e.what()<<std::endl;
+	}
+	producer.join();
+	close(fds[1]);
+
+	std::cout << "read " << in.frames << " frames, checksum " << checksum
+		<< " (want " << (long)N*(N-1)/2 << "), " << bad << " mismatches\n";
+	std::cout << "batching: " << (in.calls > 0 && in.frames / in.calls > 1 ? "yes" : "no") << "\n";
+
+	return (in.frames == N && bad == 0) ? 0 : 1;
+
+}
@@ -0,0 +1,130 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/convert.hpp"
+#include <chrono>
+#include <vector>
+
+// Stored Layout (v1)
+
+struct endpoint_v1 {
+	std::string host;
+	int port = 0;
+};
+
+struct config_v1 {
+	std::string name;
+	int timeout = 0;
+	endpoint_v1 primary;
+	std::vector<endpoint_v1> replicas;
+	bool legacy = true;
+};
+
+using endpoint_v1_t = ctom::obj<
+	ctom::key<"host", std::string>,
+	ctom::key<"port", int>
+>;
+
+struct endpoint_v1_p: endpoint_v1_t {
+	endpoint_v1_p(endpoint_v1& e):endpoint_v1_t(e.host, e.port){};
+};
+
+template<> struct ctom::rule<endpoint_v1> { typedef endpoint_v1_p type; };
+
+using config_v1_t = ctom::obj<
+	ctom::key<"name", std::string>,
+	ctom::key<"timeout", int>,
+	ctom::key<"primary", endpoint_v1>,
+	ctom::key<"replicas", std::vector<endpoint_v1>>,
+	ctom::key<"legacy", bool>
+>;
+
+struct config_v1_p: config_v1_t {
+	config_v1_p(config_v1& c):config_v1_t(c.name, c.timeout, c.primary, c.replicas, c.legacy){};
+};
+
+template<> struct ctom::rule<config_v1> { typedef config_v1_p type; };
+
+// Current Layout (v2): renamed, widened and added keys, legacy dropped
+
+struct endpoint_v2 {
+	std::string host;
+	long port = 0;
+	int weight = 1;
+};
+
+struct config_v2 {
+	std::string name;
+	long timeout_ms = 0;
+	endpoint_v2 primary;
+	std::vector<endpoint_v2> replicas;
+	int version = 2;
+};
+
+using endpoint_v2_t = ctom::obj<
+	ctom::key<"host", std::string>,
+	ctom::key<"port", long>,
+	ctom::key<"weight", int>
+>;
+
+struct endpoint_v2_p: endpoint_v2_t {
+	endpoint_v2_p(endpoint_v2& e):endpoint_v2_t(e.host, e.port, e.weight){};
+};
+
+template<> struct ctom::rule<endpoint_v2> { typedef endpoint_v2_p type; };
+
+using config_v2_t = ctom::obj<
+	ctom::key<"name", std::string>,
+	ctom::key<"timeout_ms", long>,
+	ctom::key<"primary", endpoint_v2>,
+	ctom::key<"replicas", std::vector<endpoint_v2>>,
+	ctom::key<"version", int>
+>;
+
+struct config_v2_p: config_v2_t {
+	config_v2_p(config_v2& c):config_v2_t(c.name, c.timeout_ms, c.primary, c.replicas, c.version){};
+};
+
+template<> struct ctom::rule<config_v2> { typedef config_v2_p type; };
+
+// Generated Converter
+
+using migrate_t = ctom::convert<config_v1, config_v2,
+	ctom::rename<"timeout", "timeout_ms">
+>;
+
+int main( int argc, char* args[] ) {
+
+	config_v1 old;
+	old.name = "orders";
+	old.timeout = 1500;
+	old.primary = {"db-0.internal", 5432};
+	old.replicas = {{"db-1.internal", 5433}, {"db-2.internal", 5434}};
+
+	config_v2 cur;
+	migrate_t migrate;
+	migrate(old, cur);
+
+	std::cout << ctom::yaml::emit << old;
+	std::cout << ctom::yaml::emit << cur;
+
+	// Batch Migration: the converter is reused for every record
+
+	const size_t N = 200000;
+	std::vector<config_v1> stored(N, old);
+	std::vector<config_v2> migrated(N);
+
+	auto t0 = std::chrono::steady_clock::now();
+	for(size_t n = 0; n < N; n++)
+		migrate(stored[n], migrated[n]);
+	auto t1 = std::chrono::steady_clock::now();
+
+	size_t ok = 0;
+	for(auto& c: migrated)
+		ok += (c.timeout_ms == 1500 && c.replicas.size() == 2 && c.replicas[1].port == 5434);
+
+	double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+	std::cout << "migrated " << ok << " / " << N << " records, " << ns << " ns/record\n";
+
+	return (ok == N) ? 0 : 1;
+
+}
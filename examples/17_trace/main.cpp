@@ -0,0 +1,85 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/json.hpp"
+
+#include <sstream>
+#include <string>
+
+// Build with -DCTOM_USDT (see Makefile), then attach:
+//  sudo bpftrace ctom.bt -c "./main 100000"
+
+struct limits {
+	int rps = 0;
+	int burst = 0;
+};
+
+struct service {
+	std::string name;
+	int port = 0;
+	limits limit;
+	float weight = 1.0f;
+};
+
+using limits_t = ctom::obj<
+	ctom::key<"rps", int>,
+	ctom::key<"burst", int>
+>;
+
+struct limits_p: limits_t {
+	limits_p(limits& l):limits_t(l.rps, l.burst){};
+};
+
+template<> struct ctom::rule<limits> { typedef limits_p type; };
+
+using service_t = ctom::obj<
+	ctom::key<"name", std::string>,
+	ctom::key<"port", int>,
+	ctom::key<"limit", limits>,
+	ctom::key<"weight", float>
+>;
+
+struct service_p: service_t {
+	service_p(service& s):service_t(s.name, s.port, s.limit, s.weight){};
+};
+
+template<> struct ctom::rule<service> { typedef service_p type; };
+
+int main( int argc, char* args[] ) {
+
+	size_t N = (argc > 1) ? std::stoul(args[1]) : 1000;
+
+	const std::string yaml = "name: api\nport: 8080\nlimit:\n  rps: 500\n  burst: 50\nweight: 0.5\n";
+	const std::string json = "{\"name\": \"db\", \"port\": 5432, \"limit\": {\"rps\": 100, \"burst\": 10}, \"weight\": 2}";
+	const std::string broken = "name: api\nport: eighty\n";
+
+	service s;
+	std::ostringstream out;
+	size_t errors = 0;
+
+	for(size_t n = 0; n < N; n++){
+
+		std::istringstream y(yaml);
+		y >> ctom::yaml::parse >> s;
+
+		ctom::json::parse_text(json, s);
+
+		out.str("");
+		out << ctom::json::emit(ctom::COMPACT) << s;
+
+		// Every 100th Document is Malformed: fires parse_error
+
+		if(n % 100 == 0) try {
+			std::istringstream b(broken);
+			b >> ctom::yaml::parse >> s;
+		} catch(ctom::exception e){
+			errors++;
+		}
+
+	}
+
+	std::cout << out.str() << std::endl;
+	std::cout << N << " iterations, " << errors << " parse errors" << std::endl;
+
+	return 0;
+
+}
@@ -0,0 +1,137 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/json.hpp"
+#include "../../src/parallel.hpp"
+
+#include <chrono>
+#include <sstream>
+#include <vector>
+
+// Snapshot: a few large top-level subtrees
+
+struct point {
+	int id = 0;
+	double x = 0.0;
+	double y = 0.0;
+	std::string label;
+};
+
+using point_t = ctom::obj<
+	ctom::key<"id", int>,
+	ctom::key<"x", double>,
+	ctom::key<"y", double>,
+	ctom::key<"label", std::string>
+>;
+
+struct point_p: point_t {
+	point_p(point& p):point_t(p.id, p.x, p.y, p.label){};
+};
+
+template<> struct ctom::rule<point> { typedef point_p type; };
+
+struct snapshot {
+	std::vector<point> a;
+	std::vector<point> b;
+	std::vector<point> c;
+	std::vector<point> d;
+	int version = 0;
+};
+
+using snapshot_t = ctom::obj<
+	ctom::key<"a", std::vector<point>>,
+	ctom::key<"b", std::vector<point>>,
+	ctom::key<"c", std::vector<point>>,
+	ctom::key<"d", std::vector<point>>,
+	ctom::key<"version", int>
+>;
+
+struct snapshot_p: snapshot_t {
+	snapshot_p(snapshot& s):snapshot_t(s.a, s.b, s.c, s.d, s.version){};
+};
+
+template<> struct ctom::rule<snapshot> { typedef snapshot_p type; };
+
+bool operator==(point const& a, point const& b){
+	return a.id == b.id && a.x == b.x && a.y == b.y && a.label == b.label;
+}
+
+bool operator==(snapshot const& a, snapshot const& b){
+	return a.a == b.a && a.b == b.b && a.c == b.c && a.d == b.d && a.version == b.version;
+}
+
+// Parse Timing
+
+template<typename F>
+double ms(F&& f){
+	auto t0 = std::chrono::steady_clock::now();
+	f();
+	auto t1 = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+// First error message of a parse
+
+template<typename F>
+std::string error(F&& f){
+	try {
+		f();
+	} catch(ctom::exception e){
+		return e.what();
+	}
+	return "none";
+}
+
+int main( int argc, char* args[] ) {
+
+	size_t N = (argc > 1) ? std::stoul(args[1]) : 50000;
+
+	snapshot src;
+	src.version = 3;
+	for(auto* v: {&src.a, &src.b, &src.c, &src.d})
+	for(size_t n = 0; n < N; n++)
+		v->push_back({(int)n, 0.5*n, 0.25*n, "p" + std::to_string(n)});
+
+	std::stringstream yaml, json;
+	yaml << ctom::yaml::emit << src;
+	json << ctom::json::emit(ctom::COMPACT) << src;
+	std::string y = yaml.str(), j = json.str();
+
+	int fails = 0;
+
+	// Sequential vs. Parallel (by Top-Level Key)
+
+	snapshot seq, par;
+	double t_seq, t_par;
+
+	{ std::istringstream is(y); t_seq = ms([&]{ is >> ctom::yaml::parse >> seq; }); }
+	{ std::istringstream is(y); t_par = ms([&]{ is >> ctom::yaml::parse >> ctom::parallel(4) >> par; }); }
+	std::cout << "yaml " << y.size() << " bytes: sequential " << t_seq << " ms, parallel " << t_par << " ms" << std::endl;
+	fails += !(seq == src && par == src);
+
+	seq = {}; par = {};
+	{ std::istringstream is(j); t_seq = ms([&]{ is >> ctom::json::parse >> seq; }); }
+	{ std::istringstream is(j); t_par = ms([&]{ is >> ctom::json::parse >> ctom::parallel(4) >> par; }); }
+	std::cout << "json " << j.size() << " bytes: sequential " << t_seq << " ms, parallel " << t_par << " ms" << std::endl;
+	fails += !(seq == src && par == src);
+
+	// Root Sequence: split by item
+
+	std::vector<point> items = src.a, items_par;
+	std::stringstream list;
+	list << ctom::yaml::emit << items;
+	{ std::istringstream is(list.str()); is >> ctom::yaml::parse >> ctom::parallel(4) >> items_par; }
+	fails += !(items_par == items);
+
+	// Errors: the first in document order, as in a sequential parse
+
+	const std::string broken = "a:\n  - id: 1\n    x: one\nb: []\nc:\n  - id: two\nd: []\nversion: 1\n";
+	auto e_seq = error([&]{ std::istringstream is(broken); is >> ctom::yaml::parse >> seq; });
+	auto e_par = error([&]{ std::istringstream is(broken); is >> ctom::yaml::parse >> ctom::parallel(4) >> par; });
+	std::cout << "sequential error: " << e_seq << std::endl;
+	std::cout << "parallel error:   " << e_par << std::endl;
+	fails += (e_seq != e_par);
+
+	std::cout << ((fails == 0) ? "results match" : "results differ") << std::endl;
+	return fails;
+
+}
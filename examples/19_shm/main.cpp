@@ -0,0 +1,92 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/shm.hpp"
+
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Shared Service State
+
+struct state {
+	std::string name;
+	int version = 0;
+	bool draining = false;
+	double load[3] = {0.0, 0.0, 0.0};
+	std::vector<int> ports;
+};
+
+template<> struct ctom::rule<double[3]> { typedef ctom::arr<3, double> type; };
+
+using state_t = ctom::obj<
+	ctom::key<"name", std::string>,
+	ctom::key<"version", int>,
+	ctom::key<"draining", bool>,
+	ctom::key<"load", ctom::arr<3, double>>,
+	ctom::key<"ports", std::vector<int>>
+>;
+
+struct state_p: state_t {
+	state_p(state& s):state_t(s.name, s.version, s.draining, s.load, s.ports){};
+};
+
+template<> struct ctom::rule<state> { typedef state_p type; };
+
+// Every field is derived from the version, so torn reads are detectable
+
+void fill(state& s, int v){
+	s.name = "frontend-" + std::to_string(v);
+	s.version = v;
+	s.draining = (v % 2 == 1);
+	for(auto& l: s.load) l = 0.5*v;
+	s.ports.assign(1 + v % 5, 8000 + v);
+}
+
+bool consistent(state& s){
+	state t;
+	fill(t, s.version);
+	return s.name == t.name && s.draining == t.draining && s.load[2] == t.load[2] && s.ports == t.ports;
+}
+
+int main( int argc, char* args[] ) {
+
+	const char* name = "/ctom-example-shm";
+	const int last = 20000;
+
+	ctom::shm::publisher pub(name, 1 << 12);
+
+	state s;
+	fill(s, 0);
+	pub.publish(s);
+
+	// Reader Process: decodes whichever version is current, until the last
+
+	pid_t pid = fork();
+	if(pid == 0){
+		ctom::shm::reader sub(name);
+		state r;
+		int torn = 0;
+		while(r.version != last)
+		if(sub.update(r))
+			torn += !consistent(r);
+		std::cout << "reader: version " << r.version << ", " << torn << " torn snapshots" << std::endl;
+		std::cout << ctom::yaml::emit << r;
+		std::cout.flush();
+		_exit(torn == 0 ? 0 : 1);
+	}
+
+	for(int v = 1; v <= last; v++){
+		fill(s, v);
+		pub.publish(s);
+	}
+
+	int status = 0;
+	waitpid(pid, &status, 0);
+	pub.unlink();
+
+	std::cout << "publisher: " << pub.version() << " versions, record " << pub.buf.size() << " bytes" << std::endl;
+	return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+
+}
@@ -0,0 +1,137 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/view.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Archived Order Records
+
+enum class side: uint8_t {
+	buy,
+	sell
+};
+
+template<>
+struct ctom::rule<side> {
+	typedef ctom::enum_map<side,
+		ctom::entry<"buy", side::buy>,
+		ctom::entry<"sell", side::sell>
+	> type;
+};
+
+struct order {
+	uint64_t id = 0;
+	side s = side::buy;
+	std::string symbol;
+	double price = 0.0;
+	int quantity = 0;
+	std::vector<int> fills;
+};
+
+using order_t = ctom::obj<
+	ctom::key<"id", uint64_t>,
+	ctom::key<"side", side>,
+	ctom::key<"symbol", std::string>,
+	ctom::key<"price", double>,
+	ctom::key<"quantity", int>,
+	ctom::key<"fills", std::vector<int>>
+>;
+
+struct order_p: order_t {
+	order_p(order& o):order_t(o.id, o.s, o.symbol, o.price, o.quantity, o.fills){};
+};
+
+template<> struct ctom::rule<order> { typedef order_p type; };
+
+template<typename F>
+double ms(F&& f){
+	auto t0 = std::chrono::steady_clock::now();
+	f();
+	auto t1 = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+int main( int argc, char* args[] ) {
+
+	const size_t N = (argc > 1) ? std::stoul(args[1]) : 200000;
+	const char* path = "orders.bin";
+	const char* symbols[] = {"ACME", "INITECH", "GLOBEX", "UMBRELLA"};
+
+	// Write the Record File
+
+	{
+		std::string file;
+		order o;
+		for(size_t n = 0; n < N; n++){
+			o.id = 1000 + n;
+			o.s = (n % 3 == 0) ? side::sell : side::buy;
+			o.symbol = symbols[n % 4];
+			o.price = 10.0 + 0.25*(n % 100);
+			o.quantity = 1 + n % 50;
+			o.fills.assign(n % 4, (int)(n % 7));
+			ctom::binary::encode_record(file, o);
+		}
+		std::ofstream(path, std::ios::binary).write(file.data(), file.size());
+	}
+
+	// Map It, Scan Records in Place
+
+	int fd = open(path, O_RDONLY);
+	struct stat st;
+	fstat(fd, &st);
+	const char* p = (const char*)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	std::string_view bytes(p, st.st_size);
+
+	double volume_view = 0.0, volume_decode = 0.0;
+	size_t fills_view = 0, fills_decode = 0;
+
+	double t_view = ms([&]{
+		for(auto v: ctom::records<order>(bytes)){
+			if(v.get<"side">() != side::sell || v.get<"symbol">() != "GLOBEX")
+				continue;
+			volume_view += v.get<"price">() * v.get<"quantity">();
+			auto fills = v.get<"fills">();
+			for(size_t n = 0; n < fills.size(); n++)
+				fills_view += fills[n];
+		}
+	});
+
+	// Reference: decode every record
+
+	order o;
+	double t_decode = ms([&]{
+		for(auto v: ctom::records<order>(bytes)){
+			ctom::binary::decode(v.data, o);
+			if(o.s != side::sell || o.symbol != "GLOBEX")
+				continue;
+			volume_decode += o.price * o.quantity;
+			for(auto f: o.fills)
+				fills_decode += f;
+		}
+	});
+
+	// First Record, Decoded
+
+	auto first = *ctom::records<order>(bytes).begin();
+	ctom::binary::decode(first.data, o);
+	std::cout << ctom::yaml::emit << o;
+
+	std::cout << N << " records, " << bytes.size() << " bytes" << std::endl;
+	std::cout << "view:   volume " << volume_view << ", fills " << fills_view << ", " << t_view << " ms" << std::endl;
+	std::cout << "decode: volume " << volume_decode << ", fills " << fills_decode << ", " << t_decode << " ms" << std::endl;
+
+	munmap((void*)p, st.st_size);
+	unlink(path);
+
+	return (volume_view == volume_decode && fills_view == fills_decode) ? 0 : 1;
+
+}
@@ -0,0 +1,121 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/reload.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Service Configuration
+
+struct config {
+	std::string host;
+	int port = 0;
+	int revision = 0;
+	std::vector<int> weights;
+};
+
+using config_t = ctom::obj<
+	ctom::key<"host", std::string>,
+	ctom::key<"port", int>,
+	ctom::key<"revision", int>,
+	ctom::key<"weights", std::vector<int>>
+>;
+
+struct config_p: config_t {
+	config_p(config& c):config_t(c.host, c.port, c.revision, c.weights){};
+};
+
+template<> struct ctom::rule<config> { typedef config_p type; };
+
+// Every revision has the same shape, so half-written values are detectable
+
+bool consistent(config const& c){
+	if(c.host != "node-" + std::to_string(c.revision) || c.port != 9000 + c.revision)
+		return false;
+	for(auto w: c.weights)
+		if(w != c.revision) return false;
+	return true;
+}
+
+// Replace the file atomically, as deployment tools do
+
+void deploy(std::string const& path, std::string const& text){
+	std::ofstream(path + ".tmp") << text;
+	std::rename((path + ".tmp").c_str(), path.c_str());
+}
+
+std::string revision(int r){
+	config c{"node-" + std::to_string(r), 9000 + r, r, std::vector<int>(4 + r % 3, r)};
+	std::stringstream ss;
+	ss << ctom::yaml::emit << c;
+	return ss.str();
+}
+
+// Wait until the loader has processed a change
+
+template<typename F>
+bool wait_for(F&& f){
+	for(int n = 0; n < 2000; n++){
+		if(f()) return true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return false;
+}
+
+int main( int argc, char* args[] ) {
+
+	const std::string path = "service.yaml";
+	deploy(path, revision(1));
+
+	ctom::reloader<config> cfg(path, [](config const& c){
+		if(c.port <= 0 || c.port > 65535)
+			throw std::invalid_argument("port out of range");
+	});
+
+	// Readers: pin snapshots continuously, never block
+
+	std::atomic<bool> done = false;
+	std::atomic<size_t> reads = 0, torn = 0;
+	std::vector<std::thread> readers;
+	for(int n = 0; n < 3; n++)
+		readers.emplace_back([&]{
+			while(!done){
+				auto c = cfg.read();
+				torn += !consistent(*c);
+				reads++;
+			}
+		});
+
+	// Reloads, incl. a malformed and an invalid file which are rejected
+
+	int fails = 0;
+	for(int r = 2; r <= 50; r++){
+		size_t v = cfg.version();
+		deploy(path, revision(r));
+		fails += !wait_for([&]{ return cfg.version() > v; });
+	}
+
+	deploy(path, "host: node-x\nport: [\n");
+	fails += !wait_for([&]{ return !cfg.error().empty(); });
+	std::cout << "rejected: " << cfg.error() << std::endl;
+
+	deploy(path, "host: node-51\nport: 70000\nrevision: 51\nweights: []\n");
+	fails += !wait_for([&]{ return cfg.error() == "port out of range"; });
+	std::cout << "rejected: " << cfg.error() << std::endl;
+
+	done = true;
+	for(auto& t: readers)
+		t.join();
+
+	config last = *cfg.read();
+	std::cout << ctom::yaml::emit << last;
+	std::cout << "version " << cfg.version() << ", " << (reads > 0 ? "readers ran" : "no reads") << ", " << torn << " torn reads" << std::endl;
+
+	std::remove(path.c_str());
+	return (fails == 0 && torn == 0) ? 0 : 1;
+
+}
@@ -0,0 +1,88 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/batch.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include <sys/stat.h>
+
+// Host Configuration
+
+struct host {
+	std::string name;
+	int port = 0;
+	std::vector<std::string> tags;
+};
+
+using host_t = ctom::obj<
+	ctom::key<"name", std::string>,
+	ctom::key<"port", int>,
+	ctom::key<"tags", std::vector<std::string>>
+>;
+
+struct host_p: host_t {
+	host_p(host& h):host_t(h.name, h.port, h.tags){};
+};
+
+template<> struct ctom::rule<host> { typedef host_p type; };
+
+// Load all files, check every loaded host against the file it was written to
+
+size_t check(std::vector<std::string> const& paths, std::vector<std::string> const& errors, std::vector<host> const& hosts){
+	size_t wrong = 0;
+	for(size_t n = 0; n < paths.size(); n++)
+	if(errors[n].empty())
+		wrong += (hosts[n].name != "host-" + std::to_string(n) || hosts[n].port != 8000 + (int)n || hosts[n].tags.size() != 1 + n % 4);
+	return wrong;
+}
+
+int main( int argc, char* args[] ) {
+
+	const std::string dir = "hosts";
+	const size_t count = 4000;
+	::mkdir(dir.c_str(), 0755);
+
+	std::vector<std::string> paths;
+	for(size_t n = 0; n < count; n++){
+		host h{"host-" + std::to_string(n), 8000 + (int)n, std::vector<std::string>(1 + n % 4, "rack-" + std::to_string(n % 16))};
+		paths.push_back(dir + "/" + std::to_string(n) + ".yaml");
+		std::ofstream out(paths.back());
+		out << ctom::yaml::emit << h;
+	}
+
+	// Per-file errors: a missing and a malformed file
+
+	paths.push_back(dir + "/missing.yaml");
+	paths.push_back(dir + "/broken.yaml");
+	std::ofstream(paths.back()) << "name: host-x\nport: [\n";
+
+	int fails = 0;
+	for(bool uring: {true, false}){
+
+		std::vector<host> hosts;
+		auto start = std::chrono::high_resolution_clock::now();
+		auto errors = ctom::batch::load(paths, hosts, {.uring = uring});
+		auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+		size_t loaded = 0;
+		for(auto& e: errors)
+			loaded += e.empty();
+		size_t wrong = check(paths, errors, hosts);
+
+		std::cout << (uring ? "io_uring: " : "pread:    ") << loaded << " of " << paths.size() << " files loaded, " << wrong << " wrong (" << us << " us)" << std::endl;
+		for(size_t n = count; n < paths.size(); n++)
+			std::cout << "  " << paths[n] << ": " << errors[n] << std::endl;
+
+		fails += (loaded != count || wrong != 0 || errors[count].empty() || errors[count + 1].empty());
+
+	}
+
+	for(auto& p: paths)
+		std::remove(p.c_str());
+	::rmdir(dir.c_str());
+	return fails;
+
+}
@@ -0,0 +1,117 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/column.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+// Metrics Table Row
+
+struct latency {
+	double p50 = 0.0;
+	double p99 = 0.0;
+};
+
+using latency_t = ctom::obj<
+	ctom::key<"p50", double>,
+	ctom::key<"p99", double>
+>;
+
+struct latency_p: latency_t {
+	latency_p(latency& l):latency_t(l.p50, l.p99){};
+};
+
+template<> struct ctom::rule<latency> { typedef latency_p type; };
+
+struct sample {
+	std::string host;
+	double cpu = 0.0;
+	int64_t requests = 0;
+	bool healthy = true;
+	latency lat;
+};
+
+using sample_t = ctom::obj<
+	ctom::key<"host", std::string>,
+	ctom::key<"cpu", double>,
+	ctom::key<"requests", int64_t>,
+	ctom::key<"healthy", bool>,
+	ctom::key<"latency", latency>
+>;
+
+struct sample_p: sample_t {
+	sample_p(sample& s):sample_t(s.host, s.cpu, s.requests, s.healthy, s.lat){};
+};
+
+template<> struct ctom::rule<sample> { typedef sample_p type; };
+template<> struct ctom::rule<sample[4]> { typedef ctom::arr<4, sample> type; };
+
+sample make(size_t n){
+	return {"node-" + std::to_string(n % 64), 0.01*(n % 100), (int64_t)(n*7 % 1000), n % 13 != 0, {1.0 + n % 5, 10.0 + n % 50}};
+}
+
+const char* kinds[] = {"bool", "int", "uint", "float", "string"};
+
+int main( int argc, char* args[] ) {
+
+	// Fixed-Size Table: ctom::arr<4, sample>
+
+	sample top[4];
+	for(size_t n = 0; n < 4; n++)
+		top[n] = make(n);
+
+	std::string bytes;
+	ctom::column::encode(bytes, top);
+
+	ctom::column::table t(bytes);
+	std::cout << t.rows << " rows, " << t.size() << " columns, " << bytes.size() << " bytes" << std::endl;
+	for(auto& c: t.columns)
+		std::cout << "  " << c.name << ": " << kinds[c.type] << (c.type != ctom::column::BOOL && c.width ? std::to_string(8*c.width) : "") << std::endl;
+	for(size_t n = 0; n < t.rows; n++)
+		std::cout << "  " << t["host"].text(n) << " cpu " << t["cpu"].at<double>(n) << " p99 " << t["latency.p99"].at<double>(n) << std::endl;
+
+	// Large Table: std::vector<sample>, written to a file
+
+	const size_t rows = 200000;
+	std::vector<sample> samples;
+	for(size_t n = 0; n < rows; n++)
+		samples.push_back(make(n));
+
+	auto start = std::chrono::high_resolution_clock::now();
+	ctom::column::encode(bytes, samples);
+	auto encode_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+	std::ofstream("samples.col", std::ios::binary) << bytes;
+
+	std::stringstream rowwise;
+	rowwise << ctom::yaml::emit << samples;
+
+	// Analytical Consumer: mean of one column, scanned in place vs. parsed rows
+
+	std::ifstream in("samples.col", std::ios::binary);
+	std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+	start = std::chrono::high_resolution_clock::now();
+	ctom::column::table table(file);
+	double sum = 0.0;
+	for(double cpu: table["cpu"].values<double>())
+		sum += cpu;
+	auto scan_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+	start = std::chrono::high_resolution_clock::now();
+	std::vector<sample> parsed;
+	rowwise >> ctom::yaml::parse >> parsed;
+	double check = 0.0;
+	for(auto& s: parsed)
+		check += s.cpu;
+	auto parse_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+	std::cout << rows << " rows: " << file.size() << " bytes columnar, " << rowwise.str().size() << " bytes yaml, encoded in " << encode_us << " us" << std::endl;
+	std::cout << "mean cpu " << sum / rows << " (column scan " << scan_us << " us, yaml parse " << parse_us << " us)" << std::endl;
+
+	std::remove("samples.col");
+	return (sum == check && table.rows == rows) ? 0 : 1;
+
+}
@@ -0,0 +1,137 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/csv.hpp"
+
+#include <chrono>
+#include <sstream>
+#include <vector>
+
+// Inventory Row
+
+enum class status { ACTIVE, DRAINING, RETIRED };
+
+template<>
+struct ctom::rule<status> {
+	typedef ctom::enum_map<status,
+		ctom::entry<"active", status::ACTIVE>,
+		ctom::entry<"draining", status::DRAINING>,
+		ctom::entry<"retired", status::RETIRED>
+	> type;
+};
+
+struct host {
+	std::string name;
+	int port = 0;
+	double load = 0.0;
+	bool healthy = true;
+	status state = status::ACTIVE;
+	std::string note;
+};
+
+using host_t = ctom::obj<
+	ctom::key<"name", std::string>,
+	ctom::key<"port", int>,
+	ctom::key<"load", double>,
+	ctom::key<"healthy", bool>,
+	ctom::key<"state", status>,
+	ctom::key<"note", std::string>
+>;
+
+struct host_p: host_t {
+	host_p(host& h):host_t(h.name, h.port, h.load, h.healthy, h.state, h.note){};
+};
+
+template<> struct ctom::rule<host> { typedef host_p type; };
+template<> struct ctom::rule<host[3]> { typedef ctom::arr<3, host> type; };
+
+bool same(std::vector<host> const& a, std::vector<host> const& b){
+	if(a.size() != b.size()) return false;
+	for(size_t n = 0; n < a.size(); n++)
+		if(a[n].name != b[n].name || a[n].port != b[n].port || a[n].load != b[n].load
+		|| a[n].healthy != b[n].healthy || a[n].state != b[n].state || a[n].note != b[n].note)
+			return false;
+	return true;
+}
+
+int main( int argc, char* args[] ) {
+
+	std::vector<host> hosts = {
+		{"node-0", 8000, 0.25, true, status::ACTIVE, ""},
+		{"node-1", 8001, 0.5, false, status::DRAINING, "rack 4, row 2"},
+		{"node-2", 8002, 1.0/3.0, true, status::RETIRED, "said \"bye\"\nmoved"},
+	};
+
+	std::cout << ctom::csv::emit << hosts;
+	std::cout << ctom::csv::emit(ctom::csv::TSV) << hosts;
+
+	// Round Trips
+
+	int fails = 0;
+	for(auto d: {ctom::csv::CSV, ctom::csv::TSV}){
+		std::stringstream ss;
+		ss << ctom::csv::emit(d) << hosts;
+		std::vector<host> back;
+		ss >> ctom::csv::parse(d) >> back;
+		fails += !same(hosts, back);
+	}
+
+	// Fixed-Size Tables: every row is read into its element, unbound rows are skipped
+
+	host fixed[3] = {hosts[0], hosts[1], hosts[2]};
+	std::stringstream table;
+	table << ctom::csv::emit << fixed;
+
+	host first, last;
+	ctom::arr<3, host> partial(first);
+	partial.val<2>() = last;
+	table >> ctom::csv::parse >> partial;
+	std::cout << "rows 0 and 2: " << first.name << ", " << last.name << std::endl;
+	fails += (first.name != "node-0" || last.note != hosts[2].note);
+
+	// Errors: columns out of order, a bad value
+
+	for(auto text: {"port,name,load,healthy,state,note\n8000,node-0,0,true,active,\n",
+	                "name,port,load,healthy,state,note\nnode-0,8000,0,true,active,\nnode-1,80x1,0,true,active,\n",
+	                "name,port,load,healthy,state,note\nnode-0,8000,0,true\n"}){
+		std::stringstream ss(text);
+		std::vector<host> back;
+		try {
+			ss >> ctom::csv::parse >> back;
+			fails++;
+		} catch(ctom::exception const& e){
+			std::cout << "rejected: " << e.what() << std::endl;
+		}
+	}
+
+	// Bulk Export: csv vs. yaml
+
+	std::vector<host> many;
+	for(size_t n = 0; n < 100000; n++)
+		many.push_back({"node-" + std::to_string(n), 8000 + (int)(n % 1000), 0.001*(n % 1000), n % 7 != 0, (status)(n % 3), (n % 10 == 0) ? "check, soon" : ""});
+
+	std::stringstream csv, yaml;
+	auto start = std::chrono::high_resolution_clock::now();
+	csv << ctom::csv::emit << many;
+	auto csv_emit = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+	start = std::chrono::high_resolution_clock::now();
+	yaml << ctom::yaml::emit << many;
+	auto yaml_emit = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+	std::vector<host> back;
+	start = std::chrono::high_resolution_clock::now();
+	csv >> ctom::csv::parse >> back;
+	auto csv_parse = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+	fails += !same(many, back);
+
+	start = std::chrono::high_resolution_clock::now();
+	yaml >> ctom::yaml::parse >> back;
+	auto yaml_parse = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+	std::cout << many.size() << " rows: " << csv.str().size() << " bytes csv, " << yaml.str().size() << " bytes yaml" << std::endl;
+	std::cout << "emit  csv " << csv_emit << " us, yaml " << yaml_emit << " us" << std::endl;
+	std::cout << "parse csv " << csv_parse << " us, yaml " << yaml_parse << " us" << std::endl;
+
+	return fails;
+
+}
@@ -0,0 +1,19 @@
+#include "model.hpp"
+
+#include <iostream>
+#include <string>
+
+std::string unit_0(config& c);
+
+int main( int argc, char* args[] ) {
+
+	config c{"gateway", level::WARN, {"0.0.0.0", 8080, {"public"}},
+		{{"10.0.0.1", 9000, {"a"}}, {"10.0.0.2", 9000, {"b", "canary"}}},
+		{{"rps", 1200}, {"burst", 1.5}}};
+
+	std::cout << ctom::yaml::emit << c;
+	std::cout << unit_0(c) << std::endl;
+
+	return 0;
+
+}
@@ -0,0 +1,5 @@
+#include "model.hpp"
+
+#ifndef IMPLICIT
+CTOM_INSTANTIATE(config)
+#endif
@@ -0,0 +1,73 @@
+#ifndef MODEL
+#define MODEL
+
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/json.hpp"
+#include "../../src/instance.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Service Configuration, Shared by all Translation Units
+
+enum class level { DEBUG, INFO, WARN };
+
+template<>
+struct ctom::rule<level> {
+	typedef ctom::enum_map<level,
+		ctom::entry<"debug", level::DEBUG>,
+		ctom::entry<"info", level::INFO>,
+		ctom::entry<"warn", level::WARN>
+	> type;
+};
+
+struct endpoint {
+	std::string host;
+	int port = 0;
+	std::vector<std::string> tags;
+};
+
+using endpoint_t = ctom::obj<
+	ctom::key<"host", std::string>,
+	ctom::key<"port", int>,
+	ctom::key<"tags", std::vector<std::string>>
+>;
+
+struct endpoint_p: endpoint_t {
+	endpoint_p(endpoint& e):endpoint_t(e.host, e.port, e.tags){};
+};
+
+template<> struct ctom::rule<endpoint> { typedef endpoint_p type; };
+
+struct config {
+	std::string name;
+	level log = level::INFO;
+	endpoint listen;
+	std::vector<endpoint> upstreams;
+	std::map<std::string, double> limits;
+};
+
+using config_t = ctom::obj<
+	ctom::key<"name", std::string>,
+	ctom::key<"log", level>,
+	ctom::key<"listen", endpoint>,
+	ctom::key<"upstreams", std::vector<endpoint>>,
+	ctom::key<"limits", std::map<std::string, double>>
+>;
+
+struct config_p: config_t {
+	config_p(config& c):config_t(c.name, c.log, c.listen, c.upstreams, c.limits){};
+};
+
+template<> struct ctom::rule<config> { typedef config_p type; };
+
+// Emit and parse are compiled once, in model.cpp
+//  (-DIMPLICIT instantiates them in every translation unit, for comparison)
+
+#ifndef IMPLICIT
+CTOM_EXTERN(config)
+#endif
+
+#endif
@@ -0,0 +1,22 @@
+#include "model.hpp"
+
+#include <sstream>
+
+// One of many translation units which read and write the configuration
+//  (compiled as unit_0 by default, as unit_N with -DUNIT=N)
+
+#ifndef UNIT
+#define UNIT 0
+#endif
+
+#define UNIT_NAME(n) UNIT_CAT(unit_, n)
+#define UNIT_CAT(a, b) a ## b
+
+std::string UNIT_NAME(UNIT)(config& c){
+	std::stringstream yaml, json;
+	yaml << ctom::yaml::emit << c;
+	config copy;
+	yaml >> ctom::yaml::parse >> copy;
+	json << ctom::json::emit(ctom::COMPACT) << copy;
+	return json.str();
+}
@@ -83,6 +83,12 @@ int main( int argc, char* args[] ) {
 	std::cout<<ctom::yaml::emit<<root;
 	std::cout<<ctom::json::emit<<root;
 
+	// Compact Emission
+
+	std::cout<<ctom::yaml::emit(ctom::COMPACT)<<root;
+	std::cout<<ctom::json::emit(ctom::COMPACT)<<root;
+	std::cout<<std::endl;
+
 	return 0;
 
 }
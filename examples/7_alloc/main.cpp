@@ -0,0 +1,386 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/json.hpp"
+#include "../../src/prom.hpp"
+#include "../../src/logfmt.hpp"
+#include "../../src/frame.hpp"
+#include "../../src/binary.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// Global Allocation Hook
+//	Every heap allocation in the process goes through here,
+//	so we can count exactly what a single emit / parse costs.
+
+static size_t allocations = 0;
+
+void* operator new(size_t size){
+	allocations++;
+	if(void* p = std::malloc(size))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size){ return operator new(size); }
+
+// GCC pairs inlined deletes with the builtin operator new, not this one
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+#pragma GCC diagnostic pop
+
+template<typename F>
+size_t count(F&& f){
+	size_t before = allocations;
+	f();
+	return allocations - before;
+}
+
+// Allocation-Free Stream Buffers
+
+struct nullbuf: std::streambuf {
+	int overflow(int c) override { return c; }
+	std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+struct membuf: std::streambuf {
+	std::string_view src;
+	membuf(std::string_view src):src(src){ reset(); }
+	void reset(){
+		char* p = const_cast<char*>(src.data());
+		setg(p, p, p + src.size());
+	}
+};
+
+// Representative Schemas
+
+using Arr = ctom::arr<3, int>;
+
+using Foo = ctom::obj<
+	ctom::key<"foo-int", int>,
+	ctom::key<"foo-float", float>,
+	ctom::key<"foo-double", double>
+>;
+
+using Bar = ctom::obj<
+	ctom::key<"bar-foo", Foo>,
+	ctom::key<"bar-char", char>,
+	ctom::key<"int-arr", Arr>
+>;
+
+using BarArr = ctom::arr<2, Bar>;
+
+using Root = ctom::obj<
+	ctom::key<"int", int>,
+	ctom::key<"bar", BarArr>,
+	ctom::key<"text", std::string>
+>;
+
+struct Arr_Impl: Arr {
+	int arr[3] = {9, 7, 5};
+	Arr_Impl(){
+		this->val<0>() = arr[0];
+		this->val<1>() = arr[1];
+		this->val<2>() = arr[2];
+	}
+};
+
+struct Foo_Impl: Foo {
+	int a = 10;
+	float b = 5.0f;
+	double c = 2.5;
+	Foo_Impl(){
+		this->val<"foo-int">() = a;
+		this->val<"foo-float">() = b;
+		this->val<"foo-double">() = c;
+	}
+};
+
+struct Bar_Impl: Bar {
+	Foo_Impl foo;
+	char x = 'y';
+	Arr_Impl arr;
+	Bar_Impl(){
+		this->val<"bar-foo">() = foo;
+		this->val<"bar-char">() = x;
+		this->val<"int-arr">() = arr;
+	}
+};
+
+struct BarArr_Impl: BarArr {
+	Bar_Impl b[2];
+	BarArr_Impl(){
+		this->val<0>() = b[0];
+		this->val<1>() = b[1];
+	}
+};
+
+struct Root_Impl: Root {
+	int x = 6;
+	BarArr_Impl bar;
+	std::string text = "some text";
+	Root_Impl(){
+		this->val<"int">() = x;
+		this->val<"bar">() = bar;
+		this->val<"text">() = text;
+	}
+};
+
+// String Identifiers: Owning and Viewing
+
+using Host = ctom::obj<
+	ctom::key<"region", std::string>,
+	ctom::key<"hostname", std::string>,
+	ctom::key<"status", std::string>
+>;
+
+using HostView = ctom::obj<
+	ctom::key<"region", std::string_view>,
+	ctom::key<"hostname", std::string_view>,
+	ctom::key<"status", std::string_view>
+>;
+
+struct Host_Impl: Host {
+	std::string region, hostname, status;
+	Host_Impl(){
+		this->val<"region">() = region;
+		this->val<"hostname">() = hostname;
+		this->val<"status">() = status;
+	}
+};
+
+struct HostView_Impl: HostView {
+	std::string_view region, hostname, status;
+	HostView_Impl(){
+		this->val<"region">() = region;
+		this->val<"hostname">() = hostname;
+		this->val<"status">() = status;
+	}
+};
+
+// Rule-Based Schema
+
+template<typename T>
+struct vec3 {
+	T x;
+	T y;
+	T z;
+};
+
+template<typename T>
+struct vec3_p: ctom::arr<3, T>{
+	vec3_p(vec3<T>& vec)
+	:ctom::arr<3, T>(vec.x, vec.y, vec.z){};
+};
+
+template<typename T>
+struct ctom::rule<vec3<T>>{
+	typedef vec3_p<T> type;
+};
+
+// Documents
+
+const char* foo_yaml =
+	"foo-int: 1\n"
+	"foo-float: 0.5\n"
+	"foo-double: 0.25\n";
+
+const char* root_yaml =
+	"int: 1\n"
+	"bar:\n"
+	"  - bar-foo:\n"
+	"      foo-int: 5\n"
+	"      foo-float: 2.64\n"
+	"      foo-double: 2.75\n"
+	"    bar-char: x\n"
+	"    int-arr:\n"
+	"      - 9\n"
+	"      - 7\n"
+	"      - 5\n"
+	"  - bar-foo:\n"
+	"      foo-int: 10\n"
+	"      foo-float: 3.4\n"
+	"      foo-double: 2.5\n"
+	"    bar-char: y\n"
+	"    int-arr:\n"
+	"      - 3\n"
+	"      - 9\n"
+	"      - 10\n"
+	"text: some text\n";
+
+const char* vec_yaml =
+	"- - 3\n"
+	"  - 2\n"
+	"  - 1\n"
+	"- - 4.5\n"
+	"  - 5.6\n"
+	"  - 6.7\n"
+	"- - 7.8\n"
+	"  - 8.9\n"
+	"  - 9.01\n";
+
+const char* host_yaml =
+	"region: europe-west-north-2\n"
+	"hostname: worker-0042.cluster.internal\n"
+	"status: \"draining \\\"maintenance\\\"\"\n";
+
+// Expected Allocation Counts
+//	first: cold call, steady: any further call on the same schema
+//	Note: rule-based types (vec) build their schema on every call,
+//	binding the schema once (vec_p, ctom::schema) removes this cost entirely.
+
+struct expect {
+	const char* name;
+	size_t first;
+	size_t steady;
+};
+
+int failed = 0;
+
+template<typename F>
+void check(expect e, F&& f){
+	size_t first = count(f);
+	size_t steady = count(f);
+	for(int n = 0; n < 8; n++)
+		steady = std::max(steady, count(f));
+	bool ok = (first == e.first && steady == e.steady);
+	std::cout << (ok ? "[ ok ] " : "[fail] ") << e.name
+		<< ": first " << first << " (want " << e.first << ")"
+		<< ", steady " << steady << " (want " << e.steady << ")\n";
+	if(!ok) failed++;
+}
+
+int main( int argc, char* args[] ) {
+
+	nullbuf null;
+	std::ostream out(&null);
+
+	Foo_Impl foo;
+	Root_Impl root;
+	vec3<vec3<float>> vec;
+
+	// Emit
+
+	check({"yaml emit foo", 0, 0}, [&](){ out << ctom::yaml::emit << foo; });
+	check({"yaml emit root", 3, 0}, [&](){ out << ctom::yaml::emit << root; });
+	check({"yaml emit vec", 12, 12}, [&](){ out << ctom::yaml::emit << vec; });
+	check({"json emit foo", 0, 0}, [&](){ out << ctom::json::emit << foo; });
+	check({"json emit root", 0, 0}, [&](){ out << ctom::json::emit << root; });
+	check({"json emit vec", 12, 12}, [&](){ out << ctom::json::emit << vec; });
+	check({"prom emit root", 6, 0}, [&](){ out << ctom::prom::emit << root; });
+	check({"logfmt emit root", 0, 0}, [&](){ out << ctom::logfmt::emit << root; });
+
+	// Parse
+
+	membuf foo_buf(foo_yaml);
+	membuf root_buf(root_yaml);
+	membuf vec_buf(vec_yaml);
+	std::istream foo_in(&foo_buf);
+	std::istream root_in(&root_buf);
+	std::istream vec_in(&vec_buf);
+
+	auto parse = [](std::istream& in, membuf& buf, auto& t){
+		buf.reset();
+		in.clear();
+		in >> ctom::yaml::parse >> t;
+	};
+
+	check({"yaml parse foo", 1, 0}, [&](){ parse(foo_in, foo_buf, foo); });
+	check({"yaml parse root", 1, 0}, [&](){ parse(root_in, root_buf, root); });
+	check({"yaml parse vec", 12, 12}, [&](){ parse(vec_in, vec_buf, vec); });
+
+	vec3_p<vec3<float>> vec_p(vec);
+	check({"yaml parse vec (bound)", 0, 0}, [&](){ parse(vec_in, vec_buf, vec_p); });
+
+	// Batch Records: one schema, rebound to every record
+
+	vec3<vec3<float>> batch[4];
+	ctom::schema<vec3<vec3<float>>> vec_s(batch[0]);
+	check({"yaml parse vec (rebound)", 0, 0}, [&](){
+		for(auto& v: batch){
+			vec_s.rebind(v);
+			parse(vec_in, vec_buf, vec_s);
+		}
+	});
+
+	// Sequences: elements are parsed in place through one element schema
+
+	std::vector<vec3<float>> vec_seq;
+	ctom::schema<std::vector<vec3<float>>> seq_s(vec_seq);
+	check({"yaml parse vec (sequence)", 7, 0}, [&](){ parse(vec_in, vec_buf, seq_s); });
+
+	// Fresh Records: owning strings allocate per value,
+	//	views point into a reused document (escaped values into its arena)
+
+	Host_Impl host;
+	HostView_Impl host_view;
+	ctom::document doc;
+	membuf host_buf(host_yaml);
+	std::istream host_in(&host_buf);
+
+	check({"yaml parse host (string)", 4, 3}, [&](){
+		std::string().swap(host.region);
+		std::string().swap(host.hostname);
+		std::string().swap(host.status);
+		parse(host_in, host_buf, host);
+	});
+	check({"yaml parse host (string_view)", 3, 0}, [&](){
+		host_buf.reset();
+		host_in.clear();
+		host_in >> ctom::yaml::parse(doc) >> host_view;
+	});
+
+	// Interned Records: repeated values share one copy across documents
+
+	ctom::pool names;
+	ctom::yaml::context pool_ctx;
+	pool_ctx.intern = &names;
+
+	check({"yaml parse host (pool)", 8, 0}, [&](){
+		host_buf.reset();
+		host_in.clear();
+		host_in >> ctom::yaml::parse(pool_ctx) >> host_view;
+	});
+
+	// Framed Records over a Pipe: buffers are reused across frames
+
+	int fds[2];
+	if(pipe(fds) == 0){
+		ctom::frame::writer frame_out(fds[1]);
+		ctom::frame::reader frame_in(fds[0]);
+		check({"frame write / read foo", 0, 0}, [&](){
+			frame_out.put(foo);
+			frame_out.flush();
+			frame_in.next(foo);
+		});
+		close(fds[0]);
+		close(fds[1]);
+	}
+
+	// Fixed Binary Layout: the record buffer is reused
+
+	std::string bytes;
+	check({"binary encode / decode root", 2, 0}, [&](){
+		ctom::binary::encode(bytes, root);
+		ctom::binary::decode(bytes, root);
+	});
+
+	// Explicit Context
+
+	ctom::yaml::context ctx;
+	auto parse_ctx = [&ctx](std::istream& in, membuf& buf, auto& t){
+		buf.reset();
+		in.clear();
+		in >> ctom::yaml::parse(ctx) >> t;
+	};
+
+	check({"yaml parse root (context)", 5, 0}, [&](){ parse_ctx(root_in, root_buf, root); });
+	check({"yaml emit root (context)", 0, 0}, [&](){ out << ctom::yaml::emit(ctx) << root; });
+
+	return failed;
+
+}
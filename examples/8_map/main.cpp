@@ -0,0 +1,116 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/json.hpp"
+#include <fstream>
+
+// Transparent Hash
+//	Allows lookup by std::string_view without a temporary key
+
+struct string_hash {
+	using is_transparent = void;
+	size_t operator()(std::string_view sv) const {
+		return std::hash<std::string_view>{}(sv);
+	}
+};
+
+// Well-Known Types w. Parse-Rules
+
+template<typename T>
+struct vec2 {
+	T x;
+	T y;
+};
+
+template<typename T>
+struct vec2_p: ctom::arr<2, T>{
+	vec2_p(vec2<T>& vec)
+	:ctom::arr<2, T>(vec.x, vec.y){};
+};
+
+template<typename T>
+struct ctom::rule<vec2<T>>{
+	typedef vec2_p<T> type;
+};
+
+struct backend {
+	std::string host;
+	int port = 0;
+};
+
+using backend_t = ctom::obj<
+	ctom::key<"host", std::string>,
+	ctom::key<"port", int>
+>;
+
+struct backend_p: backend_t {
+	backend_p(backend& b)
+	:backend_t(b.host, b.port){};
+};
+
+template<>
+struct ctom::rule<backend> {
+	typedef backend_p type;
+};
+
+// Routing Table w. Dynamic Keys
+
+using Table = ctom::obj<
+	ctom::key<"name", std::string>,
+	ctom::key<"routes", std::unordered_map<std::string, int, string_hash, std::equal_to<>>>,
+	ctom::key<"weights", std::map<std::string, vec2<float>>>,
+	ctom::key<"backends", std::unordered_map<std::string, backend>>
+>;
+
+struct Table_Impl: Table {
+	std::string name;
+	std::unordered_map<std::string, int, string_hash, std::equal_to<>> routes;
+	std::map<std::string, vec2<float>> weights;
+	std::unordered_map<std::string, backend> backends;
+	Table_Impl(){
+		this->val<"name">() = name;
+		this->val<"routes">() = routes;
+		this->val<"weights">() = weights;
+		this->val<"backends">() = backends;
+		this->get<"routes">().hint = 64;	// reserve buckets before parsing
+	}
+};
+
+int main( int argc, char* args[] ) {
+
+	ctom::print<Table>();
+
+	Table_Impl table;
+
+	std::ifstream yaml_file("config.yaml");
+	if(yaml_file.is_open()){
+
+		try {
+			yaml_file >> ctom::yaml::parse >> table;
+			std::cout << ctom::yaml::emit << table;
+		} catch(ctom::exception e){
+			std::cout<<"Failed to parse config.yaml: "<<e.what()<<std::endl;
+		}
+
+		yaml_file.close();
+
+	}
+
+	// Entries are merged into the existing tables
+
+	std::ifstream json_file("config.json");
+	if(json_file.is_open()){
+
+		try {
+			json_file >> ctom::json::parse >> table;
+			std::cout << ctom::json::emit << table;
+		} catch(ctom::exception e){
+			std::cout<<"Failed to parse config.json: "<<e.what()<<std::endl;
+		}
+
+		json_file.close();
+
+	}
+
+	return 0;
+
+}
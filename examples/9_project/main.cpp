@@ -0,0 +1,155 @@
+#include "../../src/ctom.hpp"
+#include "../../src/yaml.hpp"
+#include "../../src/json.hpp"
+
+#include <fstream>
+
+int main( int argc, char* args[] ) {
+
+	// Full Object Model
+
+	using Arr = ctom::arr<3, int>;
+
+	using Foo = ctom::obj<
+		ctom::key<"foo-int", int>,
+		ctom::key<"foo-float", float>,
+		ctom::key<"foo-double", double>
+	>;
+
+	using Bar = ctom::obj<
+		ctom::key<"bar-foo", Foo>,
+		ctom::key<"bar-char", char>,
+		ctom::key<"int-arr", Arr>
+	>;
+
+	using BarArr = ctom::arr<2, Bar>;
+
+	using Root = ctom::obj<
+		ctom::key<"int", int>,
+		ctom::key<"float", float>,
+		ctom::key<"bar", BarArr>,
+		ctom::key<"foo", Foo>,
+		ctom::key<"text", std::string>
+	>;
+
+	// Projected Sub-Schema
+
+	using FooView = ctom::obj<
+		ctom::key<"foo-double", double>
+	>;
+
+	using RootView = ctom::obj<
+		ctom::key<"text", std::string>,
+		ctom::key<"foo", FooView>,
+		ctom::key<"int", int>
+	>;
+
+	// Concrete Implementations
+
+	struct Arr_Impl: Arr {
+		int arr[3] = {0};
+		Arr_Impl():Arr(arr){}
+	};
+
+	struct Foo_Impl: Foo {
+		int a = 0;
+		float b = 0;
+		double c = 0;
+		Foo_Impl(){
+			this->val<"foo-int">() = a;
+			this->val<"foo-float">() = b;
+			this->val<"foo-double">() = c;
+		}
+	};
+
+	struct Bar_Impl: Bar {
+		Foo_Impl foo;
+		char x = ' ';
+		Arr_Impl arr;
+		Bar_Impl(){
+			this->val<"bar-foo">() = foo;
+			this->val<"bar-char">() = x;
+			this->val<"int-arr">() = arr;
+		}
+	};
+
+	struct BarArr_Impl: BarArr {
+		Bar_Impl b[2];
+		BarArr_Impl(){
+			this->val<0>() = b[0];
+			this->val<1>() = b[1];
+		}
+	};
+
+	struct Root_Impl: Root {
+		int x = 0;
+		float y = 0;
+		BarArr_Impl bar;
+		Foo_Impl foo;
+		std::string text;
+		Root_Impl(){
+			this->val<"int">() = x;
+			this->val<"float">() = y;
+			this->val<"bar">() = bar;
+			this->val<"foo">() = foo;
+			this->val<"text">() = text;
+		}
+	};
+
+	Root_Impl root;
+	ctom::project<RootView> view(root);
+
+	// Full Parse: Unknown Keys are Skipped
+
+	std::ifstream yaml_file("config.yaml");
+	if(yaml_file.is_open()){
+
+		try {
+			yaml_file >> ctom::yaml::parse >> root;
+			std::cout << ctom::yaml::emit << root;
+		} catch(ctom::exception e){
+			std::cout<<"Failed to parse config.yaml: "<<e.what()<<std::endl;
+		}
+
+		yaml_file.close();
+
+	}
+
+	// Projected Parse: Only the View is Converted
+
+	std::ifstream json_file("config.json");
+	if(json_file.is_open()){
+
+		try {
+			json_file >> ctom::json::parse >> view;
+			std::cout << ctom::json::emit << view;
+			std::cout << ctom::yaml::emit << root;
+		} catch(ctom::exception e){
+			std::cout<<"Failed to parse config.json: "<<e.what()<<std::endl;
+		}
+
+		json_file.close();
+
+	}
+
+	// Strict Parse: Unknown Keys are Errors
+
+	ctom::yaml::context strict;
+	strict.strict = true;
+
+	yaml_file.open("config.yaml");
+	if(yaml_file.is_open()){
+
+		try {
+			yaml_file >> ctom::yaml::parse(strict) >> root;
+		} catch(ctom::exception e){
+			std::cout<<"Failed to parse config.yaml: "<<e.what()<<std::endl;
+		}
+
+		yaml_file.close();
+
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,453 @@
+#ifndef CTOM_BATCH
+#define CTOM_BATCH
+
+#include "ctom.hpp"
+#include "yaml.hpp"
+#include "json.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace ctom {
+namespace batch {
+
+/*
+================================================================================
+                            Batch File Loading
+================================================================================
+Loads many (small) files into models at once, file n into targets[n]:
+
+  std::vector<config> configs;
+  auto errors = ctom::batch::load(paths, configs);
+  auto errors = ctom::batch::load<ctom::batch::json_format>(paths, configs);
+
+Files are opened and read through io_uring, many at a time, so that loading
+is not bound by the latency of one syscall per step and file. Every file read
+completely is handed to a pool of parse workers, which parse the buffers in
+place with their thread-local contexts while further reads are in flight.
+
+Without io_uring (kernel, seccomp) or with options::uring disabled, the pool
+workers read the files themselves with pread.
+
+Errors are reported per file: errors[n] is empty if file n was loaded, else
+the reason (open / read errors, or the parse error with its line).
+*/
+
+struct options {
+    size_t threads = 0;         // parse workers, 0: one per hardware thread
+    unsigned depth = 256;       // files in flight
+    bool uring = true;          // read through io_uring, if available
+};
+
+struct yaml_format {
+    template<typename T>
+    void operator()(std::string_view text, T& type) const {
+        yaml::parse_text(text, type);
+    }
+};
+
+struct json_format {
+    template<typename T>
+    void operator()(std::string_view text, T& type) const {
+        json::parse_text(text, type);
+    }
+};
+
+// Synchronous read of a whole file, for the fallback path
+
+inline std::string read_file(const char* path, std::string& data){
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return std::string("open: ") + std::strerror(errno);
+    struct stat st;
+    size_t size = (::fstat(fd, &st) == 0 && st.st_size > 0) ? st.st_size : 4096;
+    data.resize(size);
+    size_t n = 0;
+    while(true){
+        if(n == data.size())
+            data.resize(2*n);
+        auto r = ::pread(fd, data.data() + n, data.size() - n, n);
+        if(r < 0){
+            if(errno == EINTR) continue;
+            int e = errno;
+            ::close(fd);
+            return std::string("read: ") + std::strerror(e);
+        }
+        if(r == 0) break;
+        n += r;
+    }
+    ::close(fd);
+    data.resize(n);
+    return {};
+}
+
+/*
+================================================================================
+                            io_uring (Raw Syscalls)
+================================================================================
+A minimal submission / completion ring: one thread submits and reaps.
+*/
+
+struct ring {
+
+    int fd = -1;
+    unsigned entries = 0;
+
+    void* sq_ptr = MAP_FAILED;
+    void* cq_ptr = MAP_FAILED;
+    size_t sq_size = 0, cq_size = 0;
+    io_uring_sqe* sqes = (io_uring_sqe*)MAP_FAILED;
+    size_t sqes_size = 0;
+
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    io_uring_cqe* cqes;
+
+    unsigned queued = 0;        // pushed, not yet submitted
+
+    bool setup(unsigned n){
+
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        fd = ::syscall(__NR_io_uring_setup, n, &p);
+        if(fd < 0)
+            return false;
+
+        entries = p.sq_entries;
+        sq_size = p.sq_off.array + p.sq_entries*sizeof(unsigned);
+        cq_size = p.cq_off.cqes + p.cq_entries*sizeof(io_uring_cqe);
+        bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if(single)
+            sq_size = cq_size = std::max(sq_size, cq_size);
+
+        sq_ptr = ::mmap(NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if(sq_ptr == MAP_FAILED)
+            return false;
+        cq_ptr = single ? sq_ptr : ::mmap(NULL, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if(cq_ptr == MAP_FAILED)
+            return false;
+        sqes_size = p.sq_entries*sizeof(io_uring_sqe);
+        sqes = (io_uring_sqe*)::mmap(NULL, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if(sqes == MAP_FAILED)
+            return false;
+
+        auto sq = (char*)sq_ptr;
+        sq_head = (unsigned*)(sq + p.sq_off.head);
+        sq_tail = (unsigned*)(sq + p.sq_off.tail);
+        sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+        sq_array = (unsigned*)(sq + p.sq_off.array);
+
+        auto cq = (char*)cq_ptr;
+        cq_head = (unsigned*)(cq + p.cq_off.head);
+        cq_tail = (unsigned*)(cq + p.cq_off.tail);
+        cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+        cqes = (io_uring_cqe*)(cq + p.cq_off.cqes);
+
+        return true;
+
+    }
+
+    ~ring(){
+        if(sqes != MAP_FAILED) ::munmap(sqes, sqes_size);
+        if(cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) ::munmap(cq_ptr, cq_size);
+        if(sq_ptr != MAP_FAILED) ::munmap(sq_ptr, sq_size);
+        if(fd >= 0) ::close(fd);
+    }
+
+    // Queue an operation; the caller keeps at most entries in flight
+
+    void push(io_uring_sqe const& e){
+        unsigned tail = *sq_tail;
+        unsigned i = tail & *sq_mask;
+        sqes[i] = e;
+        sq_array[i] = i;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        queued++;
+    }
+
+    // Submit queued operations and wait for at least one completion
+
+    int enter(){
+        while(true){
+            int r = ::syscall(__NR_io_uring_enter, fd, queued, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+            if(r >= 0){
+                queued -= r;
+                return 0;
+            }
+            if(errno != EINTR)
+                return -errno;
+        }
+    }
+
+    template<typename F>
+    void reap(F&& f){
+        unsigned head = *cq_head;
+        unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        for(; head != tail; head++){
+            auto& c = cqes[head & *cq_mask];
+            f(c.user_data, c.res);
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+
+};
+
+/*
+================================================================================
+                                Batch Loader
+================================================================================
+*/
+
+template<typename T, typename Format>
+struct loader {
+
+    enum op: uint64_t { OPEN, READ, CLOSE };
+
+    std::vector<std::string> const& paths;
+    std::vector<T>& targets;
+    std::vector<std::string> errors;
+    options opt;
+    Format format;
+
+    // Per-File Read State
+
+    struct file {
+        int fd = -1;
+        std::string data;
+        size_t size = 0;        // bytes read
+        bool fallback = false;  // read synchronously by the parse worker
+    };
+
+    std::vector<file> files;
+
+    // Parse Queue
+
+    std::mutex lock;
+    std::condition_variable ready;
+    std::deque<size_t> queue;
+    bool closed = false;
+
+    loader(std::vector<std::string> const& paths, std::vector<T>& targets, options opt)
+    :paths(paths),targets(targets),errors(paths.size()),opt(opt),files(paths.size()){
+        if(targets.size() < paths.size())
+            targets.resize(paths.size());
+    }
+
+    void parse(size_t n){
+        auto& f = files[n];
+        if(f.fallback)
+            errors[n] = read_file(paths[n].c_str(), f.data);
+        if(errors[n].empty())
+        try {
+            format(std::string_view(f.data), targets[n]);
+        } catch(std::exception const& e){
+            errors[n] = e.what();
+        }
+        std::string().swap(f.data);
+    }
+
+    void hand_off(size_t n){
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            queue.push_back(n);
+        }
+        ready.notify_one();
+    }
+
+    void worker(){
+        while(true){
+            size_t n;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                ready.wait(guard, [this]{ return closed || !queue.empty(); });
+                if(queue.empty())
+                    return;
+                n = queue.front();
+                queue.pop_front();
+            }
+            parse(n);
+        }
+    }
+
+    size_t thread_count() const {
+        size_t t = opt.threads;
+        if(t == 0)
+            t = std::max<unsigned>(1, std::thread::hardware_concurrency());
+        return std::max<size_t>(1, std::min(t, paths.size()));
+    }
+
+    // Fallback: every worker reads and parses whole files
+
+    void run_pool(){
+        std::atomic<size_t> next = 0;
+        auto work = [&]{
+            size_t n;
+            while((n = next.fetch_add(1)) < paths.size()){
+                files[n].fallback = true;
+                parse(n);
+            }
+        };
+        std::vector<std::thread> pool;
+        for(size_t t = 1; t < thread_count(); t++)
+            pool.emplace_back(work);
+        work();
+        for(auto& t: pool)
+            t.join();
+    }
+
+    // io_uring: open, read (growing the buffer until a short read), close;
+    //  false if the ring is not available.
+
+    static io_uring_sqe sqe(uint8_t opcode, size_t n, op o){
+        io_uring_sqe e;
+        std::memset(&e, 0, sizeof(e));
+        e.opcode = opcode;
+        e.user_data = (n << 2) | o;
+        return e;
+    }
+
+    void submit_open(ring& r, size_t n){
+        auto e = sqe(IORING_OP_OPENAT, n, OPEN);
+        e.fd = AT_FDCWD;
+        e.addr = (uint64_t)paths[n].c_str();
+        e.open_flags = O_RDONLY | O_CLOEXEC;
+        r.push(e);
+    }
+
+    void submit_read(ring& r, size_t n){
+        auto& f = files[n];
+        if(f.data.size() == f.size)
+            f.data.resize(std::max<size_t>(4096, 2*f.size));
+        auto e = sqe(IORING_OP_READ, n, READ);
+        e.fd = f.fd;
+        e.addr = (uint64_t)(f.data.data() + f.size);
+        e.len = f.data.size() - f.size;
+        e.off = f.size;
+        r.push(e);
+    }
+
+    void submit_close(ring& r, size_t n){
+        auto e = sqe(IORING_OP_CLOSE, n, CLOSE);
+        e.fd = files[n].fd;
+        r.push(e);
+    }
+
+    void stop(std::vector<std::thread>& pool){
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            closed = true;
+        }
+        ready.notify_all();
+        for(auto& t: pool)
+            t.join();
+    }
+
+    bool run_uring(){
+
+        ring r;
+        if(!r.setup(std::max(1u, opt.depth)))
+            return false;
+
+        std::vector<std::thread> pool;
+        for(size_t t = 0; t < thread_count(); t++)
+            pool.emplace_back([this]{ worker(); });
+
+        size_t next = 0, active = 0, reaped = 0;
+        while(next < paths.size() || active > 0){
+
+            for(; next < paths.size() && active < r.entries; next++, active++)
+                submit_open(r, next);
+
+            // A ring which was set up but can not be entered (seccomp) is
+            //  not used at all; a failure after the first reads is fatal.
+            if(int e = r.enter(); e < 0){
+                if(reaped == 0){
+                    stop(pool);
+                    return false;
+                }
+                stop(pool);
+                throw std::system_error(-e, std::generic_category(), "ctom::batch: io_uring_enter");
+            }
+
+            r.reap([&](uint64_t data, int res){
+
+                reaped++;
+                size_t n = data >> 2;
+                auto& f = files[n];
+
+                switch(data & 3){
+                case OPEN:
+                    if(res == -EINVAL || res == -EOPNOTSUPP){
+                        f.fallback = true;
+                        hand_off(n);
+                        active--;
+                    } else if(res < 0){
+                        errors[n] = std::string("open: ") + std::strerror(-res);
+                        active--;
+                    } else {
+                        f.fd = res;
+                        submit_read(r, n);
+                    }
+                    break;
+                case READ:
+                    if(res < 0){
+                        errors[n] = std::string("read: ") + std::strerror(-res);
+                        submit_close(r, n);
+                    } else if(res > 0 && f.size + res == f.data.size()){
+                        f.size += res;
+                        submit_read(r, n);
+                    } else {
+                        f.size += res;
+                        f.data.resize(f.size);
+                        submit_close(r, n);
+                    }
+                    break;
+                case CLOSE:
+                    f.fd = -1;
+                    if(errors[n].empty())
+                        hand_off(n);
+                    active--;
+                    break;
+                }
+
+            });
+
+        }
+
+        stop(pool);
+        return true;
+
+    }
+
+};
+
+template<typename Format = yaml_format, typename T>
+std::vector<std::string> load(std::vector<std::string> const& paths, std::vector<T>& targets, options opt = {}){
+    loader<T, Format> l(paths, targets, opt);
+    if(!opt.uring || !l.run_uring())
+        l.run_pool();
+    return std::move(l.errors);
+}
+
+}   // end of namespace batch
+}   // end of namespace ctom
+
+#endif
@@ -0,0 +1,295 @@
+#ifndef CTOM_BINARY
+#define CTOM_BINARY
+
+#include "ctom.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ctom {
+namespace binary {
+
+/*
+================================================================================
+                            Fixed Binary Layout
+================================================================================
+A model is written as its fixed part, followed by variable data:
+
+  - numbers, bools and enums in place, little-endian, naturally aligned
+  - strings and sequences as a span {uint32 offset, uint32 size} in place,
+    their bytes / elements in the variable data
+  - arrays and objects as their members in declaration order
+
+Offsets are from the start of the record, which is aligned to 8 bytes, so
+every field can be read in place. The layout of the fixed part is computed
+at compile time:
+
+  ctom::binary::encode(bytes, config);
+  ctom::binary::decode(bytes, config);
+
+Records are read in place, without decoding, through a ctom::view.
+Dynamic-key objects and tagged unions have no fixed layout.
+*/
+
+constexpr size_t alignment = 8;
+
+constexpr size_t align_up(size_t n, size_t a){
+    return (n + a - 1) / a * a;
+}
+
+// Little-Endian Scalar Storage (any alignment)
+
+template<typename V>
+void store(char* p, V v){
+    if constexpr(std::endian::native == std::endian::little)
+        std::memcpy(p, &v, sizeof(V));
+    else {
+        char b[sizeof(V)];
+        std::memcpy(b, &v, sizeof(V));
+        std::reverse_copy(b, b + sizeof(V), p);
+    }
+}
+
+template<typename V>
+V load(const char* p){
+    V v;
+    if constexpr(std::is_same_v<V, bool>)
+        v = (*p != 0);
+    else if constexpr(std::endian::native == std::endian::little)
+        std::memcpy(&v, p, sizeof(V));
+    else {
+        char b[sizeof(V)];
+        std::reverse_copy(p, p + sizeof(V), b);
+        std::memcpy(&v, b, sizeof(V));
+    }
+    return v;
+}
+
+// Variable Data Reference
+
+struct span {
+    uint32_t offset;
+    uint32_t size;
+};
+
+inline void store_span(char* p, span s){
+    store(p, s.offset);
+    store(p + 4, s.size);
+}
+
+inline span load_span(const char* p){
+    return {load<uint32_t>(p), load<uint32_t>(p + 4)};
+}
+
+/*
+================================================================================
+                          Compile-Time Layout
+================================================================================
+size and align of the fixed part of a node, offsets of its members.
+*/
+
+template<typename V>
+concept scalar_t = std::is_arithmetic_v<V> || std::is_enum_v<V>;
+
+template<typename V>
+concept text_t = std::is_convertible_v<V const&, std::string_view>;
+
+template<typename Ref>
+using node_of = std::remove_pointer_t<decltype(std::declval<Ref&>().node.impl)>;
+
+template<typename T>
+using value_of = std::remove_reference_t<decltype(*std::declval<T&>().value)>;
+
+template<typename T>
+struct layout {
+    static_assert(val_t<T> || seq_t<T> || arr_t<T> || obj_t<T>, "node type has no fixed binary layout");
+};
+
+template<val_t T>
+struct layout<T> {
+    using V = value_of<T>;
+    static_assert(scalar_t<V> || text_t<V>, "value type has no fixed binary layout");
+    static constexpr size_t size = scalar_t<V> ? sizeof(V) : sizeof(span);
+    static constexpr size_t align = scalar_t<V> ? alignof(V) : alignof(span);
+};
+
+template<seq_t T>
+struct layout<T> {
+    using elem = layout<typename T::elem_type>;
+    static constexpr size_t size = sizeof(span);
+    static constexpr size_t align = alignof(span);
+};
+
+template<typename T> requires(arr_t<T> || obj_t<T>)
+struct layout<T> {
+
+    static constexpr size_t align = [](){
+        size_t a = 1;
+        T::for_type::iter([&]<typename Ref>(){
+            a = std::max(a, layout<node_of<Ref>>::align);
+        });
+        return a;
+    }();
+
+    static constexpr std::array<size_t, T::size> offsets = [](){
+        std::array<size_t, T::size> o{};
+        size_t at = 0, n = 0;
+        T::for_type::iter([&]<typename Ref>(){
+            at = align_up(at, layout<node_of<Ref>>::align);
+            o[n++] = at;
+            at += layout<node_of<Ref>>::size;
+        });
+        return o;
+    }();
+
+    static constexpr size_t size = [](){
+        size_t at = 0;
+        T::for_type::iter([&]<typename Ref>(){
+            at = align_up(at, layout<node_of<Ref>>::align) + layout<node_of<Ref>>::size;
+        });
+        return align_up(at, align);
+    }();
+
+};
+
+/*
+================================================================================
+                                Encoder
+================================================================================
+The fixed part of a node is written at offset at of out, its variable data
+is appended (aligned) to out.
+*/
+
+// Append n zeroed bytes at alignment a, returning their offset
+
+inline size_t append(std::string& out, size_t n, size_t a){
+    size_t at = align_up(out.size(), a);
+    if(at + n > UINT32_MAX)
+        throw parse_exception("binary record larger than 4GiB");
+    out.resize(at + n, '\0');
+    return at;
+}
+
+template<typename T>
+void put(std::string& out, size_t at, T& node){
+
+    if constexpr(val_t<T>){
+        using V = value_of<T>;
+        if constexpr(scalar_t<V>)
+            store(out.data() + at, *node.value);
+        else {
+            std::string_view s = *node.value;
+            size_t off = append(out, s.size(), 1);
+            if(!s.empty())
+                std::memcpy(out.data() + off, s.data(), s.size());
+            store_span(out.data() + at, {(uint32_t)off, (uint32_t)s.size()});
+        }
+    }
+
+    else if constexpr(seq_t<T>){
+        using L = typename layout<T>::elem;
+        size_t n = node.size();
+        size_t off = append(out, n*L::size, std::max(L::align, alignof(span)));
+        store_span(out.data() + at, {(uint32_t)off, (uint32_t)n});
+        for(size_t i = 0; i < n; i++)
+            put(out, off + i*L::size, node.at(i));
+    }
+
+    else {
+        size_t n = 0;
+        node.for_refs([&](auto&& ref){
+            size_t off = at + layout<T>::offsets[n++];
+            if(ref.node.impl != NULL)
+                put(out, off, *ref.node.impl);
+        });
+    }
+
+}
+
+template<typename T>
+void encode(std::string& out, T& type){
+    bind<T> ref(type);
+    using R = std::remove_reference_t<decltype(ref.impl)>;
+    out.clear();
+    append(out, layout<R>::size, alignment);
+    put(out, 0, ref.impl);
+    out.resize(align_up(out.size(), alignment), '\0');
+}
+
+// Record Files: every record follows its size (uint64), records are 8-byte aligned
+
+template<typename T>
+void encode_record(std::string& out, T& type){
+    static thread_local std::string record;
+    encode(record, type);
+    size_t at = align_up(out.size(), alignment);
+    out.resize(at + 8 + record.size(), '\0');
+    store<uint64_t>(out.data() + at, record.size());
+    std::memcpy(out.data() + at + 8, record.data(), record.size());
+}
+
+/*
+================================================================================
+                                Decoder
+================================================================================
+Every span is checked against the record, a record which is too short or
+refers past its end throws a parse_exception.
+*/
+
+inline std::string_view sub(std::string_view in, size_t off, size_t n){
+    if(off > in.size() || n > in.size() - off)
+        throw parse_exception("binary record truncated");
+    return in.substr(off, n);
+}
+
+template<typename T>
+void get(std::string_view in, size_t at, T& node){
+
+    if constexpr(val_t<T>){
+        using V = value_of<T>;
+        if constexpr(scalar_t<V>)
+            *node.value = load<V>(in.data() + at);
+        else {
+            auto s = load_span(in.data() + at);
+            *node.value = V(sub(in, s.offset, s.size));
+        }
+    }
+
+    else if constexpr(seq_t<T>){
+        using L = typename layout<T>::elem;
+        auto s = load_span(in.data() + at);
+        sub(in, s.offset, (size_t)s.size*L::size);
+        for(size_t i = 0; i < s.size; i++)
+            get(in, s.offset + i*L::size, node.slot(i));
+        node.trim(s.size);
+    }
+
+    else {
+        size_t n = 0;
+        node.for_refs([&](auto&& ref){
+            size_t off = at + layout<T>::offsets[n++];
+            if(ref.node.impl != NULL)
+                get(in, off, *ref.node.impl);
+        });
+    }
+
+}
+
+template<typename T>
+void decode(std::string_view in, T& type){
+    bind<T> ref(type);
+    using R = std::remove_reference_t<decltype(ref.impl)>;
+    sub(in, 0, layout<R>::size);
+    get(in, 0, ref.impl);
+}
+
+}   // end of namespace binary
+}   // end of namespace ctom
+
+#endif
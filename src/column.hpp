@@ -0,0 +1,375 @@
+#ifndef CTOM_COLUMN
+#define CTOM_COLUMN
+
+#include "ctom.hpp"
+#include "binary.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace ctom {
+namespace column {
+
+/*
+================================================================================
+                            Columnar Table Export
+================================================================================
+An array or sequence of objects is a table: one row per element, one column
+per key. The table is transposed into one contiguous buffer per column and
+written to a file in the spirit of Arrow IPC:
+
+  ctom::column::encode(bytes, samples);     // std::vector<sample>, arr<N, sample>
+
+  ctom::column::table t(bytes);
+  for(double cpu: t["cpu"].values<double>())  // scanned in place
+    ...
+
+Columns are the value members of the row object in key order, members of
+nested objects are flattened into columns named "outer.inner". Numbers,
+bools and enums are stored as little-endian fixed-width values, strings as
+u32 offsets (rows + 1) into their concatenated bytes, as in Arrow.
+
+File Layout (little-endian; buffers 64-byte aligned from the file start):
+
+  header      "CTOMCOL1", u64 rows, u32 columns, u32 0, u64 0
+  directory   per column: u32 name offset, u32 name size, u8 kind, u8 width,
+              u16 0, u32 0, u64 values offset, u64 values size,
+              u64 offsets offset, u64 offsets size
+  data        names, value and offset buffers
+
+Unbound members are written as zero / empty.
+*/
+
+constexpr char magic[8] = {'C', 'T', 'O', 'M', 'C', 'O', 'L', '1'};
+constexpr size_t alignment = 64;
+constexpr size_t header_size = 32;
+constexpr size_t entry_size = 48;
+
+enum kind: uint8_t { BOOL, INT, UINT, FLOAT, STRING };
+
+template<typename V>
+constexpr kind kind_of(){
+    if constexpr(std::is_enum_v<V>)
+        return kind_of<std::underlying_type_t<V>>();
+    else if constexpr(std::is_same_v<V, bool>)
+        return BOOL;
+    else if constexpr(std::is_floating_point_v<V>)
+        return FLOAT;
+    else if constexpr(std::is_signed_v<V>)
+        return INT;
+    else if constexpr(std::is_unsigned_v<V>)
+        return UINT;
+    else return STRING;
+}
+
+template<typename V>
+constexpr size_t width_of(){
+    if constexpr(binary::scalar_t<V>)
+        return sizeof(V);
+    else return 0;
+}
+
+// Number of Columns of a Row Object
+
+template<typename T>
+constexpr size_t count(){
+    size_t n = 0;
+    T::for_type::iter([&]<typename Ref>(){
+        using N = binary::node_of<Ref>;
+        static_assert(val_t<N> || obj_t<N>, "columns are values or nested objects");
+        if constexpr(obj_t<N>)
+            n += count<N>();
+        else n++;
+    });
+    return n;
+}
+
+/*
+================================================================================
+                                  Writer
+================================================================================
+*/
+
+struct buffer {
+    std::string name;
+    kind type;
+    size_t width;
+    std::string values;
+    std::string offsets;        // strings only
+};
+
+// Column Descriptions, from the Key List
+
+template<typename T>
+void describe(std::vector<buffer>& cols, std::string const& prefix){
+    T::for_type::iter([&]<typename Ref>(){
+        using N = binary::node_of<Ref>;
+        std::string name = prefix + static_cast<char const*>(Ref::key);
+        if constexpr(obj_t<N>)
+            describe<N>(cols, name + ".");
+        else {
+            using V = binary::value_of<N>;
+            static_assert(binary::scalar_t<V> || binary::text_t<V>, "value type has no column layout");
+            cols.push_back({name, kind_of<V>(), width_of<V>(), {}, {}});
+        }
+    });
+}
+
+inline void append_offset(buffer& b){
+    if(b.values.size() > UINT32_MAX)
+        throw parse_exception("column " + b.name + " larger than 4GiB");
+    size_t at = b.offsets.size();
+    b.offsets.resize(at + 4);
+    binary::store<uint32_t>(b.offsets.data() + at, b.values.size());
+}
+
+template<typename N>
+void put_value(buffer& b, N* node){
+    using V = binary::value_of<N>;
+    if constexpr(binary::scalar_t<V>){
+        size_t at = b.values.size();
+        b.values.resize(at + sizeof(V));
+        binary::store<V>(b.values.data() + at, (node != NULL) ? *node->value : V{});
+    }
+    else {
+        if(node != NULL){
+            std::string_view s = *node->value;
+            b.values.append(s.data(), s.size());
+        }
+        append_offset(b);
+    }
+}
+
+// Append one row, its columns starting at cols
+
+template<typename T>
+void put_row(buffer* cols, T* node){
+    size_t c = 0;
+    auto put = [&]<typename N>(N* member){
+        if constexpr(obj_t<N>){
+            put_row(cols + c, member);
+            c += count<N>();
+        }
+        else put_value(cols[c++], member);
+    };
+    if(node == NULL)
+        T::for_type::iter([&]<typename Ref>(){ put((binary::node_of<Ref>*)NULL); });
+    else node->for_refs([&](auto&& ref){ put(ref.node.impl); });
+}
+
+// Rows of a Table: arrays of one object type, or sequences of objects
+
+template<typename R>
+struct rows_of {
+    static_assert(arr_t<R> || seq_t<R>, "a table is an array or sequence of objects");
+};
+
+template<seq_t R>
+struct rows_of<R> {
+    using row = typename R::elem_type;
+    template<typename F>
+    static void each(R& table, F&& f){
+        for(size_t n = 0; n < table.size(); n++)
+            f(&table.at(n));
+    }
+    static size_t size(R& table){
+        return table.size();
+    }
+};
+
+template<arr_t R>
+struct rows_of<R> {
+    using row = binary::node_of<std::tuple_element_t<0, decltype(R::nodes)>>;
+    static_assert([](){
+        bool same = true;
+        R::for_type::iter([&]<typename Ref>(){
+            same = same && std::is_same_v<binary::node_of<Ref>, row>;
+        });
+        return same;
+    }(), "table rows must all be of one object type");
+    template<typename F>
+    static void each(R& table, F&& f){
+        table.for_refs([&](auto&& ref){
+            f(ref.node.impl);
+        });
+    }
+    static size_t size(R&){
+        return R::size;
+    }
+};
+
+template<typename T>
+void encode(std::string& out, T& type){
+
+    bind<T> ref(type);
+    using R = std::remove_reference_t<decltype(ref.impl)>;
+    using rows = rows_of<R>;
+    using row = typename rows::row;
+    static_assert(obj_t<row>, "table rows must be objects");
+
+    // Transpose the rows into column buffers
+
+    std::vector<buffer> cols;
+    describe<row>(cols, "");
+
+    size_t n = rows::size(ref.impl);
+    for(auto& b: cols){
+        b.values.reserve((b.type == STRING) ? 16*n : b.width*n);
+        if(b.type == STRING){
+            b.offsets.reserve(4*(n + 1));
+            append_offset(b);
+        }
+    }
+    rows::each(ref.impl, [&](row* r){
+        put_row(cols.data(), r);
+    });
+
+    // Header and Directory
+
+    out.clear();
+    out.resize(header_size + entry_size*cols.size(), '\0');
+    std::memcpy(out.data(), magic, sizeof(magic));
+    binary::store<uint64_t>(out.data() + 8, n);
+    binary::store<uint32_t>(out.data() + 16, cols.size());
+
+    auto place = [&](std::string_view s, size_t a){
+        size_t at = binary::align_up(out.size(), a);
+        out.resize(at);
+        out.append(s.data(), s.size());
+        return at;
+    };
+
+    for(size_t c = 0; c < cols.size(); c++){
+        size_t name = place(cols[c].name, 1);
+        char* e = out.data() + header_size + entry_size*c;
+        binary::store<uint32_t>(e, name);
+        binary::store<uint32_t>(e + 4, cols[c].name.size());
+        e[8] = cols[c].type;
+        e[9] = cols[c].width;
+    }
+
+    for(size_t c = 0; c < cols.size(); c++){
+        size_t values = place(cols[c].values, alignment);
+        size_t offsets = cols[c].offsets.empty() ? 0 : place(cols[c].offsets, alignment);
+        char* e = out.data() + header_size + entry_size*c;
+        binary::store<uint64_t>(e + 16, values);
+        binary::store<uint64_t>(e + 24, cols[c].values.size());
+        binary::store<uint64_t>(e + 32, offsets);
+        binary::store<uint64_t>(e + 40, cols[c].offsets.size());
+    }
+
+    out.resize(binary::align_up(out.size(), alignment), '\0');
+
+}
+
+/*
+================================================================================
+                                  Reader
+================================================================================
+Reads a table in place. All buffers are checked against the bytes on open,
+values are read in place by values<V>(), or at any alignment by at<V>(n).
+*/
+
+struct column {
+
+    std::string_view name;
+    kind type;
+    size_t width;
+    size_t rows;
+    std::string_view data;      // values
+    std::string_view offsets;   // strings only
+
+    // Value Buffer as a Span, for Scans
+
+    template<typename V>
+    std::span<V const> values() const {
+        static_assert(binary::scalar_t<V>, "only fixed-width columns are read as spans");
+        if(type != kind_of<V>() || width != sizeof(V))
+            throw parse_exception("column " + std::string(name) + " has a different type");
+        if(std::endian::native != std::endian::little || reinterpret_cast<uintptr_t>(data.data()) % alignof(V) != 0)
+            throw parse_exception("column " + std::string(name) + " can not be read in place");
+        return {reinterpret_cast<V const*>(data.data()), rows};
+    }
+
+    template<typename V>
+    V at(size_t n) const {
+        if(type != kind_of<V>() || width != sizeof(V))
+            throw parse_exception("column " + std::string(name) + " has a different type");
+        if(n >= rows)
+            throw parse_exception("column row out of range");
+        return binary::load<V>(data.data() + n*sizeof(V));
+    }
+
+    std::string_view text(size_t n) const {
+        if(type != STRING)
+            throw parse_exception("column " + std::string(name) + " is not a string column");
+        if(n >= rows)
+            throw parse_exception("column row out of range");
+        size_t begin = binary::load<uint32_t>(offsets.data() + 4*n);
+        size_t end = binary::load<uint32_t>(offsets.data() + 4*n + 4);
+        return binary::sub(data, begin, (end >= begin) ? end - begin : SIZE_MAX);
+    }
+
+};
+
+struct table {
+
+    std::vector<column> columns;
+    size_t rows;
+
+    table(std::string_view data){
+
+        auto head = binary::sub(data, 0, header_size);
+        if(std::memcmp(head.data(), magic, sizeof(magic)) != 0)
+            throw parse_exception("not a ctom::column table");
+        rows = binary::load<uint64_t>(head.data() + 8);
+        size_t n = binary::load<uint32_t>(head.data() + 16);
+
+        auto dir = binary::sub(data, header_size, entry_size*n);
+        for(size_t c = 0; c < n; c++){
+
+            const char* e = dir.data() + entry_size*c;
+            column col;
+            col.name = binary::sub(data, binary::load<uint32_t>(e), binary::load<uint32_t>(e + 4));
+            col.type = static_cast<kind>(e[8]);
+            col.width = static_cast<uint8_t>(e[9]);
+            col.rows = rows;
+            col.data = binary::sub(data, binary::load<uint64_t>(e + 16), binary::load<uint64_t>(e + 24));
+            col.offsets = binary::sub(data, binary::load<uint64_t>(e + 32), binary::load<uint64_t>(e + 40));
+
+            if(col.type > STRING)
+                throw parse_exception("column " + std::string(col.name) + " has an unknown type");
+            if(col.type == STRING ? col.offsets.size()/4 != rows + 1 : col.width == 0 || col.data.size()/col.width != rows)
+                throw parse_exception("column " + std::string(col.name) + " does not have " + std::to_string(rows) + " rows");
+            columns.push_back(col);
+
+        }
+
+    }
+
+    size_t size() const {
+        return columns.size();
+    }
+
+    column const& operator[](size_t c) const {
+        return columns.at(c);
+    }
+
+    column const& operator[](std::string_view name) const {
+        for(auto& c: columns)
+            if(c.name == name) return c;
+        throw parse_exception("no column " + std::string(name));
+    }
+
+};
+
+}   // end of namespace column
+}   // end of namespace ctom
+
+#endif
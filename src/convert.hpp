@@ -0,0 +1,167 @@
+#ifndef CTOM_CONVERT
+#define CTOM_CONVERT
+
+#include "ctom.hpp"
+
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
+namespace ctom {
+
+/*
+================================================================================
+                            Schema Conversion
+================================================================================
+A converter copies every key of an old model into the equally named (or
+renamed) key of a new model. Keys are matched at compile time, so a
+conversion is a straight sequence of field copies:
+
+  ctom::convert<config_v1, config_v2,
+    ctom::rename<"timeout", "timeout_ms">
+  > migrate;
+
+  migrate(old_config, new_config);
+
+Keys only in the new model keep their value, keys only in the old model are
+dropped. Matched keys of incompatible types fail to compile. Renames apply
+to the keys of the outermost objects.
+
+Both models are bound once and rebound per call (see ctom::schema), so
+converting many records does not rebuild or allocate schemas.
+*/
+
+template<constexpr_string From, constexpr_string To>
+struct rename {
+  static constexpr auto from = From;
+  static constexpr auto to = To;
+};
+
+template<constexpr_string A, constexpr_string B>
+constexpr bool same_key(){
+  return std::string_view(A.value, A.size()) == std::string_view(B.value, B.size());
+}
+
+// Old key of a new key: the key renamed to it, or itself
+
+template<constexpr_string K>
+constexpr auto source_key(){
+  return K;
+}
+
+template<constexpr_string K, typename R, typename... Rs>
+constexpr auto source_key(){
+  if constexpr(same_key<R::to, K>())
+    return R::from;
+  else return source_key<K, Rs...>();
+}
+
+// Compile-time key containment of an object type (or a type derived from one)
+
+template<typename K, key_ref_t... refs>
+constexpr bool has_key(obj_impl<refs...> const*){
+  return is_ref_contained<K, refs...>::value;
+}
+
+template<typename T, constexpr_string K>
+concept keyed = obj_t<T> && has_key<key_impl<K>>((T*)NULL);
+
+// Node Copy
+
+template<typename S, typename D, typename... Rs>
+void copy(S& src, D& dst){
+
+  if constexpr(obj_t<S> && obj_t<D>){
+    static_assert((keyed<S, Rs::from> && ...), "renamed key not found in the old model");
+    static_assert((keyed<D, Rs::to> && ...), "renamed key not found in the new model");
+    dst.for_refs([&src](auto&& ref){
+      using R = std::decay_t<decltype(ref)>;
+      constexpr auto K = source_key<R::key, Rs...>();
+      if constexpr(keyed<S, K>){
+        auto& sref = src.template get<key_impl<K>>();
+        if(sref.node.impl != NULL && ref.node.impl != NULL)
+          copy(*sref.node.impl, *ref.node.impl);
+      }
+    });
+  }
+
+  else if constexpr(arr_t<S> && arr_t<D>){
+    static_assert(S::size == D::size, "arrays of different size");
+    dst.for_refs([&src](auto&& ref){
+      using R = std::decay_t<decltype(ref)>;
+      auto& sref = src.template get<ind_impl<R::ind>>();
+      if(sref.node.impl != NULL && ref.node.impl != NULL)
+        copy(*sref.node.impl, *ref.node.impl);
+    });
+  }
+
+  else if constexpr(val_t<S> && val_t<D>){
+    using VS = std::remove_reference_t<decltype(*src.value)>;
+    using VD = std::remove_reference_t<decltype(*dst.value)>;
+    static_assert(std::is_assignable_v<VD&, VS const&>, "incompatible value types");
+    *dst.value = *src.value;
+  }
+
+  // Containers: whole if the types agree, else element by element
+
+  else if constexpr((seq_t<S> && seq_t<D>) || (map_t<S> && map_t<D>) || (var_t<S> && var_t<D>)){
+    using VS = std::remove_reference_t<decltype(*src.value)>;
+    using VD = std::remove_reference_t<decltype(*dst.value)>;
+    if constexpr(std::is_assignable_v<VD&, VS const&>)
+      *dst.value = *src.value;
+    else if constexpr(seq_t<S>){
+      size_t size = src.size();
+      for(size_t n = 0; n < size; n++)
+        copy(src.at(n), dst.slot(n));
+      dst.trim(size);
+    }
+    else if constexpr(map_t<S>){
+      std::string scratch;
+      for(auto& e: *src.value){
+        auto& entry = dst.entry(e.first, scratch);
+        bind<typename S::mapped_type> a(e.second);
+        bind<typename D::mapped_type> b(entry.second);
+        copy(a.impl, b.impl);
+      }
+    }
+    else static_assert(std::is_assignable_v<VD&, VS const&>, "tagged unions of different types");
+  }
+
+  else static_assert(std::is_same_v<S, D>, "incompatible node kinds");
+
+}
+
+// Converter: Holds the Bound Models
+
+template<typename T>
+struct bound {
+  std::unique_ptr<schema<T>> impl;
+  auto& operator()(T& t){
+    if(impl == NULL) impl = std::make_unique<schema<T>>(t);
+    else impl->rebind(t);
+    return static_cast<typename rule<T>::type&>(*impl);
+  }
+};
+
+template<impl_t T>
+struct bound<T> {
+  T& operator()(T& t){
+    return t;
+  }
+};
+
+template<typename Old, typename New, typename... Renames>
+struct convert {
+
+  bound<Old> from;
+  bound<New> to;
+
+  void operator()(Old& o, New& n){
+    copy<typename rule<Old>::type, typename rule<New>::type, Renames...>(from(o), to(n));
+  }
+
+};
+
+}   // end of namespace ctom
+
+#endif
@@ -0,0 +1,446 @@
+#ifndef CTOM_CSV
+#define CTOM_CSV
+
+#include "ctom.hpp"
+#include "escape.hpp"
+#include "scalar.hpp"
+#include "enum.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <string>
+#include <string_view>
+
+namespace ctom {
+namespace csv {
+
+/*
+================================================================================
+                            CSV / TSV Tables
+================================================================================
+A sequence or array of flat objects is written as a table, with one row per
+element and one column per key:
+
+  std::vector<host> hosts;
+  std::cout << ctom::csv::emit << hosts;
+  std::cout << ctom::csv::emit(ctom::csv::TSV) << hosts;
+  is >> ctom::csv::parse >> hosts;
+
+  name,port,healthy
+  node-0,8000,true
+
+The header row is built from the key names at compile time. Rows are
+formatted with to_chars into the context buffer, which is written out in
+large pieces. Fields are quoted as in RFC 4180 when they hold the delimiter,
+a quote or a line break (quotes are doubled); this applies to TSV as well.
+
+The parser checks the header row once against the compiled header: columns
+must be in key order. Fields are then located with the vectorized byte scan
+and assigned by position.
+*/
+
+enum dialect: char {
+    CSV = ',',
+    TSV = '\t'
+};
+
+// Co-State: buf holds the pending output, esc quoted fields with doubled quotes
+
+using context = ctom::context<char>;
+using exception = ctom::exception;
+
+// Stream Modifiers
+
+struct ostream_csv: ctom::ostream_base{
+    typedef csv::context context;
+    context* ctx = NULL;
+    dialect d = CSV;
+    ostream_csv operator()(dialect d) const { return {{}, NULL, d}; }
+    ostream_csv operator()(context& c, dialect d = CSV) const { return {{}, &c, d}; }
+} inline emit;
+
+struct istream_csv: ctom::istream_base{
+    typedef csv::context context;
+    context* ctx = NULL;
+    document* doc = NULL;
+    dialect d = CSV;
+    istream_csv operator()(dialect d) const { return {{}, NULL, NULL, d}; }
+    istream_csv operator()(context& c, dialect d = CSV) const { return {{}, &c, NULL, d}; }
+    istream_csv operator()(document& doc, dialect d = CSV) const { return {{}, NULL, &doc, d}; }
+} inline parse;
+
+struct ostream {
+    std::ostream& os;
+    context& ctx;
+    dialect d;
+};
+
+struct istream {
+    std::istream& is;
+    context& ctx;
+    dialect d;
+};
+
+inline ostream operator<<(std::ostream& os, ostream_csv const& m){
+    return {os, (m.ctx != NULL) ? *m.ctx : ctom::local<context>(), m.d};
+}
+
+inline istream operator>>(std::istream& is, istream_csv const& m){
+    auto& ctx = (m.ctx != NULL) ? *m.ctx : ctom::local<context>();
+    ctx.target = m.doc;
+    return {is, ctx, m.d};
+}
+
+/*
+================================================================================
+                            Compile-Time Header
+================================================================================
+*/
+
+template<char D>
+constexpr bool needs_quotes(std::string_view s){
+    for(char c: s)
+        if(c == D || c == '"' || c == '\n' || c == '\r')
+            return true;
+    return false;
+}
+
+template<char D>
+constexpr size_t field_size(std::string_view s){
+    if(!needs_quotes<D>(s))
+        return s.size();
+    return s.size() + 2 + std::count(s.begin(), s.end(), '"');
+}
+
+// Row type of a table: the elements of an array or sequence
+
+template<typename T>
+struct row_of {
+    static_assert(arr_t<T> || seq_t<T>, "a table is an array or sequence of flat objects");
+};
+
+template<seq_t T>
+struct row_of<T> {
+    using type = typename T::elem_type;
+};
+
+template<arr_t T>
+struct row_of<T> {
+    using type = std::remove_pointer_t<decltype(std::get<0>(std::declval<T&>().nodes).node.impl)>;
+};
+
+template<typename T, char D>
+constexpr size_t header_size(){
+    static_assert(obj_t<T>, "table rows must be objects");
+    size_t n = 0;
+    T::for_type::iter([&]<typename Ref>(){
+        using N = std::remove_pointer_t<decltype(std::declval<Ref&>().node.impl)>;
+        static_assert(val_t<N>, "table rows must be flat objects");
+        if(n > 0) n++;
+        n += field_size<D>(std::string_view(Ref::key.value, Ref::key.size()));
+    });
+    return n;
+}
+
+template<typename T, char D>
+constexpr auto header(){
+    constexpr size_t N = header_size<T, D>();
+    char v[N + 1] = {};
+    size_t n = 0;
+    T::for_type::iter([&]<typename Ref>(){
+        std::string_view key(Ref::key.value, Ref::key.size());
+        if(n > 0) v[n++] = D;
+        bool quote = needs_quotes<D>(key);
+        if(quote) v[n++] = '"';
+        for(char c: key){
+            if(c == '"') v[n++] = '"';
+            v[n++] = c;
+        }
+        if(quote) v[n++] = '"';
+    });
+    return constexpr_string<N>(v);
+}
+
+/*
+================================================================================
+                                 Emitter
+================================================================================
+*/
+
+constexpr size_t flush_size = 1 << 16;
+
+template<char D>
+void put_string(std::string& buf, std::string_view s){
+    auto end = s.data() + s.size();
+    auto q = escape::scan<false, D, '"', '\n', '\r'>(s.data(), end);
+    if(q == end){
+        buf.append(s);
+        return;
+    }
+    buf += '"';
+    for(auto p = s.data(); p < end; ){
+        q = escape::scan<false, '"'>(p, end);
+        buf.append(p, q - p);
+        if(q == end)
+            break;
+        buf.append("\"\"", 2);
+        p = q + 1;
+    }
+    buf += '"';
+}
+
+template<char D, typename V>
+void put_val(std::string& buf, V const& v){
+    if constexpr(std::is_same_v<V, bool>)
+        buf.append(v ? "true" : "false");
+    else if constexpr(number_t<V>){
+        size_t at = buf.size();
+        buf.resize(at + 64);
+        auto res = std::to_chars(buf.data() + at, buf.data() + buf.size(), v);
+        buf.resize(res.ptr - buf.data());
+    }
+    else if constexpr(std::is_same_v<V, char>)
+        put_string<D>(buf, std::string_view(&v, 1));
+    else if constexpr(std::is_convertible_v<V const&, std::string_view>)
+        put_string<D>(buf, v);
+    else static_assert(std::is_same_v<V, bool>, "value type has no csv form");
+}
+
+template<char D, val_t T>
+void put_node(std::string& buf, T& node){
+    if constexpr(enum_t<T>){
+        auto name = T::name(*node.value);
+        if(name.empty()) put_val<D>(buf, +(typename T::U)*node.value);
+        else put_string<D>(buf, name);
+    }
+    else put_val<D>(buf, *node.value);
+}
+
+template<char D, typename T>
+void put_row(std::string& buf, T* row){
+    size_t n = 0;
+    size_t begin = buf.size();
+    if(row != NULL)
+    row->for_refs([&](auto&& ref){
+        if(n++ > 0) buf += D;
+        if(ref.node.impl != NULL)
+            put_node<D>(buf, *ref.node.impl);
+    });
+    else buf.append(T::size > 0 ? T::size - 1 : 0, D);
+    if(buf.size() == begin)     // an empty line would end the table
+        buf += "\"\"";
+    buf += '\n';
+}
+
+template<char D, typename T>
+void put_table(std::ostream& os, std::string& buf, T& table){
+
+    using R = typename row_of<T>::type;
+    constexpr auto head = header<R, D>();
+
+    buf.clear();
+    buf.reserve(flush_size + 4096);
+    buf.append(head.value, head.size());
+    buf += '\n';
+
+    auto flush = [&](){
+        if(buf.size() >= flush_size){
+            os.write(buf.data(), buf.size());
+            buf.clear();
+        }
+    };
+
+    if constexpr(seq_t<T>)
+        for(size_t n = 0; n < table.size(); n++){
+            put_row<D>(buf, &table.at(n));
+            flush();
+        }
+    else table.for_refs([&](auto&& ref){
+        put_row<D>(buf, ref.node.impl);
+        flush();
+    });
+
+    os.write(buf.data(), buf.size());
+    buf.clear();
+
+}
+
+template<typename T>
+std::ostream& operator<<(ostream const& os, T& type){
+    bind<T> ref(type);
+    if(os.d == TSV) put_table<TSV>(os.os, os.ctx.buf, ref.impl);
+    else put_table<CSV>(os.os, os.ctx.buf, ref.impl);
+    return os.os;
+}
+
+/*
+================================================================================
+                                  Parser
+================================================================================
+*/
+
+// End of a row: a line break or the end of the text
+
+inline bool end_of_row(context& ctx){
+    auto& src = ctx.src;
+    if(src.empty())
+        return true;
+    if(src[0] == '\n'){
+        src.remove_prefix(1);
+        return true;
+    }
+    if(src[0] == '\r' && src.size() > 1 && src[1] == '\n'){
+        src.remove_prefix(2);
+        return true;
+    }
+    return false;
+}
+
+// No further rows: only line breaks remain
+
+inline bool end_of_table(context& ctx){
+    return ctx.src.find_first_not_of("\r\n") == std::string_view::npos;
+}
+
+// Next field: unquoted fields are views into the text, quoted fields with
+//  doubled quotes are resolved into the context.
+
+template<char D>
+std::string_view get_field(context& ctx){
+
+    auto& src = ctx.src;
+    auto end = src.data() + src.size();
+
+    if(src.empty() || src[0] != '"'){
+        auto q = escape::scan<false, D, '\n', '\r'>(src.data(), end);
+        std::string_view field(src.data(), q - src.data());
+        src.remove_prefix(field.size());
+        return field;
+    }
+
+    auto p = src.data() + 1;
+    bool doubled = false;
+    while(true){
+        p = escape::scan<false, '"'>(p, end);
+        if(p == end)
+            throw exception(ctx.line, "unterminated quoted field");
+        if(p + 1 < end && p[1] == '"'){
+            doubled = true;
+            p += 2;
+            continue;
+        }
+        break;
+    }
+
+    std::string_view field(src.data() + 1, p - src.data() - 1);
+    ctx.line += std::count(field.begin(), field.end(), '\n');
+    src.remove_prefix(field.size() + 2);
+
+    if(!doubled)
+        return field;
+    ctx.esc.clear();
+    for(size_t n = 0; n < field.size(); n++){
+        ctx.esc += field[n];
+        if(field[n] == '"') n++;
+    }
+    return ctx.esc;
+
+}
+
+template<char D, typename T>
+void get_row(context& ctx, T& row){
+
+    size_t n = 0;
+    row.for_refs([&](auto&& ref){
+        if(n++ > 0){
+            if(ctx.src.empty() || ctx.src[0] != D)
+                throw exception(ctx.line, "expected " + std::to_string(T::size) + " columns");
+            ctx.src.remove_prefix(1);
+        }
+        auto field = get_field<D>(ctx);
+        if(ref.node.impl != NULL)
+        try {
+            parse_node(*ref.node.impl, field, ctx);
+        } catch(parse_exception e){
+            throw exception(ctx.line, std::string("failed to parse value: ") + e.what());
+        }
+    });
+
+    if(!end_of_row(ctx))
+        throw exception(ctx.line, "expected " + std::to_string(T::size) + " columns");
+    ctx.line++;
+
+}
+
+// Skip the row of an unbound element: its fields are scanned, not converted
+
+template<char D, typename T>
+void skip_row(context& ctx){
+
+    for(size_t n = 0; n < T::size; n++){
+        if(n > 0){
+            if(ctx.src.empty() || ctx.src[0] != D)
+                throw exception(ctx.line, "expected " + std::to_string(T::size) + " columns");
+            ctx.src.remove_prefix(1);
+        }
+        get_field<D>(ctx);
+    }
+
+    if(!end_of_row(ctx))
+        throw exception(ctx.line, "expected " + std::to_string(T::size) + " columns");
+    ctx.line++;
+
+}
+
+template<char D, typename T>
+void get_table(context& ctx, T& table){
+
+    using R = typename row_of<T>::type;
+    constexpr auto head = header<R, D>();
+
+    // Header Row, validated once
+
+    ctx.line = 1;
+    auto eol = std::min(ctx.src.find('\n'), ctx.src.size());
+    auto line = ctx.src.substr(0, eol);
+    if(!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+    if(line != std::string_view(head.value, head.size()))
+        throw exception(ctx.line, "header does not match the model, expected: " + std::string(head.value, head.size()));
+    ctx.src.remove_prefix(std::min(eol + 1, ctx.src.size()));
+    ctx.line++;
+
+    // Rows
+
+    if constexpr(seq_t<T>){
+        size_t n = 0;
+        while(!end_of_table(ctx))
+            get_row<D>(ctx, table.slot(n++));
+        table.trim(n);
+    }
+    else {
+        table.for_refs([&](auto&& ref){
+            if(end_of_table(ctx))
+                throw exception(ctx.line, "expected " + std::to_string(T::size) + " rows");
+            if(ref.node.impl != NULL)
+                get_row<D>(ctx, *ref.node.impl);
+            else skip_row<D, R>(ctx);
+        });
+        if(!end_of_table(ctx))
+            throw exception(ctx.line, "expected " + std::to_string(T::size) + " rows");
+    }
+
+}
+
+template<typename T>
+void operator>>(istream is, T& type){
+    bind<T> ref(type);
+    ctom::read(is.is, is.ctx);
+    if(is.d == TSV) get_table<TSV>(is.ctx, ref.impl);
+    else get_table<CSV>(is.ctx, ref.impl);
+}
+
+}   // end of namespace csv
+}   // end of namespace ctom
+
+#endif
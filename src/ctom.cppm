@@ -0,0 +1,109 @@
+/*
+================================================================================
+                            ctom Module Interface
+================================================================================
+The model definitions and the yaml and json backends as a C++20 module, so
+that the library headers are parsed once per build instead of once per
+translation unit:
+
+  import ctom;
+
+  template<> struct ctom::rule<config> { typedef config_p type; };
+  std::cout << ctom::yaml::emit << config;
+
+The headers are included in the global module fragment and their public
+names are exported, so module and header users share the same entities and
+can be mixed in one program. Macros (CTOM_INSTANTIATE, CTOM_TRACE) are not
+exported: include src/instance.hpp / src/trace.hpp for those.
+
+Building the interface (compiler support for modules required):
+
+  clang++ -std=c++20 --precompile -x c++-module src/ctom.cppm -o ctom.pcm
+  g++ -std=c++20 -fmodules-ts -c -x c++ src/ctom.cppm
+*/
+
+module;
+
+#include "ctom.hpp"
+#include "yaml.hpp"
+#include "json.hpp"
+
+export module ctom;
+
+export namespace ctom {
+
+    // Model Definition
+
+    using ctom::obj;
+    using ctom::arr;
+    using ctom::key;
+    using ctom::ind;
+    using ctom::rule;
+    using ctom::bind;
+    using ctom::schema;
+    using ctom::project;
+    using ctom::constexpr_string;
+
+    using ctom::val_impl;
+    using ctom::arr_impl;
+    using ctom::obj_impl;
+    using ctom::map_impl;
+    using ctom::seq_impl;
+
+    using ctom::entry;
+    using ctom::enum_map;
+    using ctom::alt;
+    using ctom::tagged;
+
+    using ctom::val_t;
+    using ctom::arr_t;
+    using ctom::obj_t;
+    using ctom::map_t;
+    using ctom::var_t;
+    using ctom::seq_t;
+    using ctom::impl_t;
+
+    // Documents, Contexts and Errors
+
+    using ctom::document;
+    using ctom::pool;
+    using ctom::context;
+    using ctom::local;
+    using ctom::exception;
+    using ctom::parse_exception;
+    using ctom::format;
+    using ctom::PRETTY;
+    using ctom::COMPACT;
+    using ctom::print;
+
+}
+
+export namespace ctom::yaml {
+
+    using ctom::yaml::context;
+    using ctom::yaml::exception;
+    using ctom::yaml::ostream;
+    using ctom::yaml::istream;
+    using ctom::yaml::emit;
+    using ctom::yaml::parse;
+    using ctom::yaml::operator<<;
+    using ctom::yaml::operator>>;
+    using ctom::yaml::load;
+    using ctom::yaml::parse_text;
+
+}
+
+export namespace ctom::json {
+
+    using ctom::json::context;
+    using ctom::json::exception;
+    using ctom::json::ostream;
+    using ctom::json::istream;
+    using ctom::json::emit;
+    using ctom::json::parse;
+    using ctom::json::operator<<;
+    using ctom::json::operator>>;
+    using ctom::json::load;
+    using ctom::json::parse_text;
+
+}
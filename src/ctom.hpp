@@ -2,9 +2,21 @@
 #define CTOM
 
 #include <cstddef>
+#include <cstdint>
 #include <tuple>
+#include <bitset>
 #include <type_traits>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <memory>
 #include <iostream>
 
 namespace ctom {
@@ -20,12 +32,24 @@ struct node_base{};
 struct val_base{ static constexpr char const* type = "val"; };
 struct arr_base{ static constexpr char const* type = "arr"; };
 struct obj_base{ static constexpr char const* type = "obj"; };
+struct map_base{ static constexpr char const* type = "map"; };
+struct var_base{ static constexpr char const* type = "var"; };
+struct seq_base{ static constexpr char const* type = "seq"; };
 
 template<typename T> concept node_t = std::derived_from<T, ctom::node_base>;
 template<typename T> concept val_t = std::derived_from<T, ctom::val_base>;
 template<typename T> concept arr_t = std::derived_from<T, ctom::arr_base>;
 template<typename T> concept obj_t = std::derived_from<T, ctom::obj_base>;
-template<typename T> concept impl_t = val_t<T>|| arr_t<T> || obj_t<T>;
+template<typename T> concept map_t = std::derived_from<T, ctom::map_base>;
+template<typename T> concept var_t = std::derived_from<T, ctom::var_base>;
+template<typename T> concept seq_t = std::derived_from<T, ctom::seq_base>;
+template<typename T> concept impl_t = val_t<T>|| arr_t<T> || obj_t<T> || map_t<T> || var_t<T> || seq_t<T>;
+
+// Value Nodes w. Named Values (enum.hpp)
+
+struct enum_base{};
+
+template<typename T> concept enum_t = val_t<T> && std::derived_from<T, ctom::enum_base>;
 
 /*
 ================================================================================
@@ -114,6 +138,9 @@ we find out which the intended interpretation type is using an interpret rule.
 template<typename T> struct val_impl;
 template<ind_ref_t... T> struct arr_impl;
 template<key_ref_t... T> struct obj_impl;
+template<typename T> struct map_impl;
+template<typename T> struct seq_impl;
+template<typename T> struct schema;
 
 // Templated Interpretation Rules
 
@@ -132,7 +159,61 @@ struct rule<T> {
   typedef T type;
 };
 
+template<map_t T>
+struct rule<T> {
+  typedef T type;
+};
+
+template<var_t T>
+struct rule<T> {
+  typedef T type;
+};
+
+template<seq_t T>
+struct rule<T> {
+  typedef T type;
+};
+
+// String-Keyed Containers are Dynamic-Key Objects
+
+template<typename T, typename... Ts>
+struct rule<std::map<std::string, T, Ts...>> {
+  typedef map_impl<std::map<std::string, T, Ts...>> type;
+};
+
+template<typename T, typename... Ts>
+struct rule<std::unordered_map<std::string, T, Ts...>> {
+  typedef map_impl<std::unordered_map<std::string, T, Ts...>> type;
+};
+
+// Dynamically-Sized Containers are Sequences
+
+template<typename T, typename A>
+requires(!std::is_same_v<T, bool>)
+struct rule<std::vector<T, A>> {
+  typedef seq_impl<std::vector<T, A>> type;
+};
+
+// In-Place Binding Scope
+//  Active while a schema is built (see schema): implementation types assigned
+//  to its nodes are referenced in place, so that rebinding relocates them.
+
+struct in_place {
+  static inline thread_local size_t depth = 0;
+  bool active = true;
+  in_place(){ depth++; }
+  ~in_place(){ end(); }
+  void end(){
+    if(active) depth--;
+    active = false;
+  }
+};
+
 // Node Implementation w. Assignment Operator
+//  The first assignment binds the node through a new node of the value's
+//  interpretation type (implementation types are copied), or in place in
+//  an in_place scope. Further assignments write through the binding, if the
+//  value is assignable (e.g. std::atomic values are only bound).
 
 template<impl_t T>
 struct node_impl: node_base {
@@ -141,12 +222,32 @@ struct node_impl: node_base {
 
   template<typename V>
   void operator=(V& v){
-    if(impl == NULL)
-      impl = new typename rule<V>::type(v);
-    *impl = v;
+    if(impl == NULL){
+      if constexpr(impl_t<V>)
+        impl = (in_place::depth > 0) ? &v : new V(static_cast<V const&>(v));
+      else impl = new typename rule<V>::type(v);
+    }
+    else if constexpr(std::is_assignable_v<T&, V&>)
+      *impl = v;
   }
 };
 
+// Instance Binding
+//  Implementation types are used in place, all other types
+//  are bound through a temporary of their interpretation type.
+
+template<typename T>
+struct bind {
+  typename rule<T>::type impl;
+  bind(T& t):impl(t){}
+};
+
+template<impl_t T>
+struct bind<T> {
+  T& impl;
+  bind(T& t):impl(t){}
+};
+
 /*
 ================================================================================
                 Implementation Forward Declarations and Aliases
@@ -306,11 +407,11 @@ struct val_impl: val_base {
   val_impl(T& t) noexcept {
 		value = &t;
 	}
-  void operator=(T& v){
+  void operator=(T& v) requires std::is_copy_assignable_v<T> {
     if(value != NULL)
     *value = v;
   }
-  void operator=(T&& v){
+  void operator=(T&& v) requires std::is_move_assignable_v<T> {
     if(value != NULL)
     *value = v;
   }
@@ -425,6 +526,19 @@ struct obj_impl: obj_base {
     }, nodes);
   }
 
+  // First bound key which is not marked in seen (by key index), or NULL
+
+  const char* missing(std::bitset<size> const& seen){
+    const char* key = NULL;
+    size_t n = 0;
+    for_refs([&](auto&& ref){
+      if(key == NULL && ref.node.impl != NULL && !seen[n])
+        key = ref.key;
+      n++;
+    });
+    return key;
+  }
+
   // Extension
 
   template<key_alias_t... srefs>
@@ -480,6 +594,214 @@ struct obj_impl: obj_base {
   }
 };
 
+// Dynamic-Key Object: Binds a String-Keyed Container
+
+template<typename M>
+struct map_impl: map_base {
+
+  typedef typename M::value_type value_type;
+  typedef typename M::mapped_type mapped_type;
+
+  M* value;
+  size_t hint = 0;  // expected entry count, reserved before parsing
+
+  map_impl(M& m) noexcept {
+    value = &m;
+  }
+  void operator=(M& m){
+    if(value != NULL)
+    *value = m;
+  }
+  void operator=(M&& m){
+    if(value != NULL)
+    *value = m;
+  }
+
+  // Reserve Buckets from the Size-Hint
+
+  void reserve(){
+    if constexpr(requires(M& m){ m.reserve(hint); })
+    if(hint > value->size())
+      value->reserve(hint);
+  }
+
+  // Find or insert an entry; transparent containers are searched with
+  // the view directly, all others through a reused scratch key.
+
+  value_type& entry(std::string_view key, std::string& scratch){
+    auto it = value->end();
+    if constexpr(requires(M& m){ m.find(key); })
+      it = value->find(key);
+    else {
+      scratch.assign(key);
+      it = value->find(scratch);
+    }
+    if(it == value->end())
+      it = value->try_emplace(std::string(key)).first;
+    return *it;
+  }
+
+  // Iterate entries in stable (key) order; unordered containers are
+  // sorted through a reused scratch vector, used as a stack for nesting.
+
+  template<typename F>
+  void for_entries(std::vector<void const*>& order, F&& f){
+    if constexpr(requires { typename M::key_compare; }){
+      for(auto& e: *value)
+        f(e);
+    } else {
+      size_t base = order.size();
+      for(auto& e: *value)
+        order.push_back(&e);
+      std::sort(order.begin() + base, order.end(), [](void const* a, void const* b){
+        return static_cast<value_type const*>(a)->first < static_cast<value_type const*>(b)->first;
+      });
+      for(size_t n = base; n < order.size(); n++)
+        f(*static_cast<value_type*>(const_cast<void*>(order[n])));
+      order.resize(base);
+    }
+  }
+
+};
+
+// Sequence: Binds a Dynamically-Sized Container
+//  All elements are accessed through one element schema,
+//  which is rebound from slot to slot instead of being rebuilt.
+
+template<typename V>
+struct seq_impl: seq_base {
+
+  typedef typename V::value_type value_type;
+  typedef typename rule<value_type>::type elem_type;
+
+  static_assert(!impl_t<value_type>, "sequence elements must be bound through their rule");
+
+  V* value;
+  std::unique_ptr<schema<value_type>> elem;
+
+  seq_impl(V& v) noexcept {
+    value = &v;
+  }
+  void operator=(V& v){
+    if(value != NULL)
+    *value = v;
+  }
+  void operator=(V&& v){
+    if(value != NULL)
+    *value = v;
+  }
+
+  size_t size() const {
+    return value->size();
+  }
+
+  // Schema of Element n
+
+  elem_type& at(size_t n){
+    auto& e = (*value)[n];
+    if(elem == NULL)
+      elem = std::make_unique<schema<value_type>>(e);
+    else elem->rebind(e);
+    return *elem;
+  }
+
+  // Parse Slot n: existing elements are reused (keeping their storage),
+  //  the sequence is extended at its end.
+
+  elem_type& slot(size_t n){
+    if(n == value->size())
+      value->emplace_back();
+    return at(n);
+  }
+
+  // Drop the slots past the last parsed element
+
+  void trim(size_t n){
+    if(n < value->size())
+      value->erase(value->begin() + n, value->end());
+  }
+
+};
+
+// Projection: Binds a Sub-Schema to the Matching Keys of a Model
+//  Keys are matched at compile time. Nested objects of differing
+//  type are projected recursively, all other types must match.
+
+template<obj_t Sub>
+struct project: Sub {
+
+  template<obj_t Full>
+  project(Full& full){
+    this->for_refs([&full](auto&& ref){
+      using R = std::decay_t<decltype(ref)>;
+      auto& fref = full.template get<key_impl<R::key>>();
+      using X = std::remove_pointer_t<decltype(ref.node.impl)>;
+      using Y = std::remove_pointer_t<decltype(fref.node.impl)>;
+      if constexpr(std::is_same_v<X, Y>)
+        ref.node.impl = fref.node.impl;
+      else if constexpr(obj_t<X> && obj_t<Y>){
+        if(fref.node.impl != NULL)
+          ref.node.impl = new project<X>(*fref.node.impl);
+      }
+      else static_assert(std::is_same_v<X, Y>, "projected key has a different type");
+    });
+  }
+
+};
+
+// Relocation: shifts every binding which points into [lo, hi) by d.
+//  Nodes bound in place inside the range are shifted as a whole,
+//  all other nodes are followed down to their values.
+
+template<typename P>
+P* shift(P* p, std::ptrdiff_t d){
+  return reinterpret_cast<P*>(reinterpret_cast<std::uintptr_t>(p) + d);
+}
+
+template<impl_t T>
+void relocate(T& node, std::uintptr_t lo, std::uintptr_t hi, std::ptrdiff_t d){
+  auto inside = [lo, hi](void const* p){
+    auto u = reinterpret_cast<std::uintptr_t>(p);
+    return u >= lo && u < hi;
+  };
+  if constexpr(arr_t<T> || obj_t<T>){
+    node.for_refs([&](auto&& ref){
+      if(ref.node.impl == NULL) return;
+      if(inside(ref.node.impl))
+        ref.node.impl = shift(ref.node.impl, d);
+      else relocate(*ref.node.impl, lo, hi, d);
+    });
+  }
+  else if(inside(node.value))
+    node.value = shift(node.value, d);
+}
+
+// Rebindable Schema: Built Once, Bound to Any Target of its Type
+//  Rebinding relocates the bindings into the previous target onto the new
+//  one, so it neither allocates nor re-runs the rule's constructor. Bindings
+//  which do not point into the target itself (e.g. through a pointer member)
+//  keep pointing where the rule's constructor put them.
+
+template<typename T>
+struct schema: private in_place, rule<T>::type {
+
+  typedef typename rule<T>::type impl_type;
+
+  T* target;
+
+  schema(T& t):in_place(),impl_type(t),target(&t){
+    in_place::end();
+  }
+
+  void rebind(T& t){
+    auto lo = reinterpret_cast<std::uintptr_t>(target);
+    auto d = (std::ptrdiff_t)(reinterpret_cast<std::uintptr_t>(&t) - lo);
+    relocate(static_cast<impl_type&>(*this), lo, lo + sizeof(T), d);
+    target = &t;
+  }
+
+};
+
 /*
 ================================================================================
                         Marshal/Unmarshal Base Types
@@ -515,18 +837,216 @@ struct istream_base{};
 template<typename T> concept ostream_t = std::derived_from<T, ctom::ostream_base>;
 template<typename T> concept istream_t = std::derived_from<T, ctom::istream_base>;
 
-template<ostream_t>
+// Block Arena
+//  Stable storage for copied strings: blocks are never moved or resized.
+
+struct arena {
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t used = 0;
+    size_t size = 0;
+
+    std::string_view store(std::string_view v){
+        if(v.empty())
+            return {};
+        if(used + v.size() > size){
+            size = std::max<size_t>(4096, v.size());
+            blocks.emplace_back(new char[size]);
+            used = 0;
+        }
+        char* p = blocks.back().get() + used;
+        std::memcpy(p, v.data(), v.size());
+        used += v.size();
+        return std::string_view(p, v.size());
+    }
+
+    // Drop all strings, keeping the last block for reuse
+
+    void clear(){
+        if(blocks.size() > 1){
+            auto last = std::move(blocks.back());
+            blocks.clear();
+            blocks.push_back(std::move(last));
+        }
+        used = 0;
+    }
+
+};
+
+// Document Handle
+//  Owns the text of a parsed document, so that std::string_view values can
+//  point directly into it. Values which had to be unescaped are kept in an
+//  arena of the document instead. Views stay valid while the handle lives,
+//  also when it is moved.
+
+struct document {
+
+    struct storage {
+        std::string text;
+        std::string_view shared;    // text of another document, kept as-is too
+        ctom::arena arena;
+    };
+
+    std::unique_ptr<storage> data = std::make_unique<storage>();
+
+    std::string_view text() const {
+        return data->text;
+    }
+
+    // Drop all values of a previous parse
+
+    void clear(){
+        data->text.clear();
+        data->shared = {};
+        data->arena.clear();
+    }
+
+    // Stable view of v: views into the text are kept as-is
+
+    std::string_view keep(std::string_view v){
+        auto within = [&](std::string_view text){
+            return v.data() >= text.data() && v.data() + v.size() <= text.data() + text.size();
+        };
+        if(within(data->text) || (data->shared.data() != NULL && within(data->shared)))
+            return v;
+        return data->arena.store(v);
+    }
+
+};
+
+// String Interning Pool
+//  Deduplicates std::string_view values across all documents parsed with a
+//  context it is attached to (ctx.intern = &pool). Equal strings share one
+//  copy, so interned views compare equal by address and outlive documents.
+
+struct pool {
+
+    ctom::arena arena;
+    std::unordered_set<std::string_view> set;
+
+    std::string_view intern(std::string_view v){
+        auto it = set.find(v);
+        if(it != set.end())
+            return *it;
+        auto kept = arena.store(v);
+        set.insert(kept);
+        return kept;
+    }
+
+    size_t size() const {
+        return set.size();
+    }
+
+    // Bytes of string storage, shared by all handed out views
+
+    size_t bytes() const {
+        size_t n = 0;
+        for(auto& v: set)
+            n += v.size();
+        return n;
+    }
+
+    void clear(){
+        set.clear();
+        arena.clear();
+    }
+
+};
+
+
+// Reusable Co-State
+//  Holds all scratch storage of an emit / parse, so that a context reused
+//  across documents stops allocating after warm-up.
+
+template<typename S>
+struct context {
+    std::vector<S> ind;     // depth-indexed indentation stack
+    std::string doc;        // document (line) storage
+    std::string buf;        // scratch buffer
+    std::string esc;        // unescaped string scratch
+    std::vector<void const*> order; // scratch entry order
+    std::string_view src;   // unparsed remainder of doc
+    std::string_view text;  // full text of the current parse
+    size_t line = 0;
+    bool strict = false;    // throw on unknown keys instead of skipping them
+    document* target = NULL;    // owner of the text, for string_view values
+    pool* intern = NULL;        // shared storage for string_view values
+
+    S& at(size_t depth){
+        if(ind.size() <= depth)
+            ind.resize(depth + 1);
+        return ind[depth];
+    }
+};
+
+// Default context per backend and thread
+
+template<typename C>
+C& local(){
+    static thread_local C ctx;
+    return ctx;
+}
+
+// Read a full document into the context, reusing its storage.
+//  The stream is read up to its end (eofbit is set): a parse takes the rest
+//  of the stream as one document, and a pipe is read until its writer closes.
+
+template<typename S>
+void read(std::istream& is, context<S>& ctx){
+    if(ctx.target != NULL)
+        ctx.target->clear();
+    auto& doc = (ctx.target != NULL) ? ctx.target->data->text : ctx.doc;
+    size_t n = 0;
+    doc.resize(doc.capacity());
+    if(is.rdbuf() != NULL)
+    while(true){
+        if(n == doc.size())
+            doc.resize(2*n + 256);
+        auto want = doc.size() - n;
+        auto have = is.rdbuf()->sgetn(doc.data() + n, want);
+        n += have;
+        if((size_t)have < want) break;
+    }
+    is.setstate(std::ios::eofbit);
+    doc.resize(n);
+    ctx.text = doc;
+    ctx.src = doc;
+    ctx.line = 0;
+}
+
+// Value-Emitter
+//  Numbers are written with to_chars in their shortest round-trip form.
+
+template<typename T>
+concept number_t = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>;
+
+template<number_t T>
+void emit_number(std::ostream& os, T t){
+    char buf[64];
+    auto res = std::to_chars(buf, buf + sizeof(buf), t);
+    os.write(buf, res.ptr - buf);
+}
+
+// Emit Formats, Selectable per Call
+
+enum format {
+    PRETTY,
+    COMPACT
+};
+
+template<ostream_t T>
 struct ostream {
-    explicit ostream(std::ostream& os):os(os){}
+    explicit ostream(std::ostream& os, typename T::context& ctx, format fmt = PRETTY):os(os),ctx(ctx),fmt(fmt){}
     std::ostream& os;
+    typename T::context& ctx;
+    format fmt;
 };
 
-template<istream_t>
+template<istream_t T>
 struct istream {
-    explicit istream(std::istream& is):is(is){}
+    explicit istream(std::istream& is, typename T::context& ctx):is(is),ctx(ctx){}
     std::istream& is;
-    std::string cur;
-    size_t line = 0;
+    typename T::context& ctx;
 };
 
 /*
@@ -563,6 +1083,16 @@ struct printer<ref_impl<IK, node_impl<T>>>{
   }
 };
 
+template<ctom::ind_key_t IK, impl_t T>
+requires(map_t<T> || var_t<T> || seq_t<T>)
+struct printer<ref_impl<IK, node_impl<T>>>{
+  static void print(size_t shift = 0){
+    for(size_t s = 0; s < shift; s++) std::cout<<"  ";
+    std::cout<<T::type<<": ";
+    std::cout<<"["<<IK::val<<"]\n";
+  }
+};
+
 template<ctom::ind_key_t IK, obj_t T>
 struct printer<ref_impl<IK, node_impl<T>>>{
   static void print(size_t shift = 0){
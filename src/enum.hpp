@@ -0,0 +1,168 @@
+#ifndef CTOM_ENUM
+#define CTOM_ENUM
+
+#include "ctom.hpp"
+#include "scalar.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace ctom {
+
+/*
+================================================================================
+                              Enumeration Nodes
+================================================================================
+An enum_map is a value node which is written and read by name. Its names are
+known at compile time, so parsing uses a perfect hash (name_table) and
+emitting a dense table indexed by value.
+
+  template<> struct ctom::rule<level> {
+    typedef ctom::enum_map<level,
+      ctom::entry<"debug", level::DEBUG>,
+      ctom::entry<"info", level::INFO>
+    > type;
+  };
+
+Values without a name are written as their underlying integer,
+which is also accepted on parse.
+*/
+
+template<constexpr_string N, auto V>
+struct entry {
+  static constexpr auto name = N;
+  static constexpr auto value = V;
+};
+
+// Seeded FNV-1a w. Final Mix
+
+constexpr uint32_t name_hash(std::string_view s, uint32_t seed){
+  uint32_t h = 2166136261u ^ seed;
+  for(char c: s){
+    h ^= (unsigned char)c;
+    h *= 16777619u;
+  }
+  return h ^ (h >> 15);
+}
+
+// Compile-Time Perfect Hash over a Fixed Set of Names
+//  The smallest seed which maps all names into distinct slots of a
+//  power-of-two table is searched at compile time, so that a lookup
+//  is one hash and one string compare.
+
+template<size_t N>
+struct name_table {
+
+  static constexpr size_t M = std::bit_ceil(2*N);
+
+  std::array<std::string_view, N> names{};
+  uint32_t seed = ~0u;
+  std::array<uint16_t, M> slot{};
+
+  constexpr name_table(std::array<std::string_view, N> _names):names(_names){
+    for(uint32_t s = 0; s < (1u << 20); s++){
+      slot.fill(N);
+      bool ok = true;
+      for(size_t i = 0; i < N && ok; i++){
+        auto& k = slot[name_hash(names[i], s) & (M - 1)];
+        if(k != N) ok = false;
+        else k = i;
+      }
+      if(ok){
+        seed = s;
+        return;
+      }
+    }
+  }
+
+  constexpr bool valid() const {
+    return seed != ~0u;
+  }
+
+  // Index of a name, N if unknown
+
+  constexpr size_t find(std::string_view s) const {
+    size_t i = slot[name_hash(s, seed) & (M - 1)];
+    return (i < N && names[i] == s) ? i : N;
+  }
+
+};
+
+template<typename E, typename... Es>
+struct enum_map: val_impl<E>, enum_base {
+
+  static_assert(std::is_enum_v<E>, "enum_map requires an enum type");
+  static_assert(sizeof...(Es) > 0, "enum_map requires at least one entry");
+  static_assert((std::is_same_v<std::decay_t<decltype(Es::value)>, E> && ...), "entry value has a different type");
+
+  using val_impl<E>::val_impl;
+  using val_impl<E>::operator=;
+
+  using U = std::underlying_type_t<E>;
+  static constexpr size_t N = sizeof...(Es);
+
+  static constexpr E values[N] = { Es::value... };
+  static constexpr name_table<N> table{{ std::string_view(Es::name.value, Es::name.size())... }};
+  static_assert(table.valid(), "enum_map names have no perfect hash (duplicate names?)");
+
+  // Dense Emit Table over [lo, hi], if the value range is small
+
+  static constexpr U lo = std::min({ (U)Es::value... });
+  static constexpr U hi = std::max({ (U)Es::value... });
+  static constexpr bool dense = (uint64_t)((int64_t)hi - (int64_t)lo) < 4*N + 64;
+  static constexpr size_t D = dense ? (size_t)(hi - lo) + 1 : 1;
+
+  static constexpr std::array<uint16_t, D> make_dense(){
+    std::array<uint16_t, D> d{};
+    d.fill(N);
+    if constexpr(dense)
+    for(size_t i = N; i-- > 0;)
+      d[(U)values[i] - lo] = i;
+    return d;
+  }
+
+  static constexpr std::array<uint16_t, D> by_value = make_dense();
+
+  // Name of a value, empty if it has none
+
+  static std::string_view name(E e){
+    if constexpr(dense){
+      U u = (U)e;
+      if(u >= lo && u <= hi && by_value[u - lo] != N)
+        return table.names[by_value[u - lo]];
+    } else {
+      for(size_t i = 0; i < N; i++)
+        if(values[i] == e) return table.names[i];
+    }
+    return "";
+  }
+
+  static bool find(std::string_view s, E& e){
+    size_t i = table.find(s);
+    if(i == N)
+      return false;
+    e = values[i];
+    return true;
+  }
+
+  void parse(std::string_view s){
+    if(find(s, *this->value))
+      return;
+    if(!s.empty() && (s.front() == '-' || (s.front() >= '0' && s.front() <= '9'))){
+      U u;
+      scalar::parse_int(u, s);
+      *this->value = (E)u;
+      return;
+    }
+    throw parse_exception(std::string("invalid enum name: \"") + std::string(s) + "\"");
+  }
+
+};
+
+}   // end of namespace ctom
+
+#endif
@@ -0,0 +1,228 @@
+#ifndef CTOM_ESCAPE
+#define CTOM_ESCAPE
+
+#include "ctom.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ctom {
+namespace escape {
+
+/*
+================================================================================
+                            Vectorized Byte Scan
+================================================================================
+Finds the first byte in [p, end) which is one of Cs, or (if ctrl) any control
+byte < 0x20. Runs of clean bytes are tested 16 (SSE2) or 8 (SWAR) at a time,
+so callers can bulk-copy them and only drop to a slow path at a match.
+*/
+
+template<bool ctrl, char... Cs>
+const char* scan(const char* p, const char* end){
+
+#if defined(__SSE2__)
+
+    const __m128i low = _mm_set1_epi8(0x1F);
+    while(end - p >= 16){
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i m = _mm_setzero_si128();
+        if constexpr(ctrl)
+            m = _mm_cmpeq_epi8(_mm_max_epu8(x, low), low);
+        ((m = _mm_or_si128(m, _mm_cmpeq_epi8(x, _mm_set1_epi8(Cs)))), ...);
+        unsigned mask = _mm_movemask_epi8(m);
+        if(mask != 0)
+            return p + std::countr_zero(mask);
+        p += 16;
+    }
+
+#else
+
+    // SWAR: the lowest flagged byte of each test is exact,
+    //  false positives only occur above a true match.
+
+    if constexpr(std::endian::native == std::endian::little){
+        constexpr uint64_t ones = 0x0101010101010101ull;
+        constexpr uint64_t high = 0x8080808080808080ull;
+        while(end - p >= 8){
+            uint64_t x;
+            std::memcpy(&x, p, 8);
+            uint64_t m = 0;
+            if constexpr(ctrl)
+                m = (x - ones * 0x20) & ~x & high;
+            ((m |= ((x ^ (ones * (unsigned char)Cs)) - ones) & ~(x ^ (ones * (unsigned char)Cs)) & high), ...);
+            if(m != 0)
+                return p + (std::countr_zero(m) >> 3);
+            p += 8;
+        }
+    }
+
+#endif
+
+    for(; p < end; p++){
+        if(ctrl && (unsigned char)*p < 0x20)
+            return p;
+        if(((*p == Cs) || ...))
+            return p;
+    }
+    return end;
+
+}
+
+/*
+================================================================================
+                                  Escaping
+================================================================================
+*/
+
+// Escape Sequence for a Single Byte
+
+inline void put_escape(std::ostream& os, char c){
+    switch(c){
+        case '"':  os.write("\\\"", 2); break;
+        case '\\': os.write("\\\\", 2); break;
+        case '\n': os.write("\\n", 2); break;
+        case '\t': os.write("\\t", 2); break;
+        case '\r': os.write("\\r", 2); break;
+        case '\b': os.write("\\b", 2); break;
+        case '\f': os.write("\\f", 2); break;
+        default: {
+            const char* hex = "0123456789abcdef";
+            char u[6] = {'\\', 'u', '0', '0', hex[(c >> 4) & 0xF], hex[c & 0xF]};
+            os.write(u, 6);
+        }
+    }
+}
+
+// Double-Quoted String Content (valid for both json and yaml)
+
+inline void put_escaped(std::ostream& os, std::string_view s){
+    const char* p = s.data();
+    const char* end = p + s.size();
+    while(true){
+        const char* q = scan<true, '"', '\\'>(p, end);
+        os.write(p, q - p);
+        if(q == end)
+            return;
+        put_escape(os, *q);
+        p = q + 1;
+    }
+}
+
+/*
+================================================================================
+                                 Unescaping
+================================================================================
+*/
+
+inline unsigned parse_hex(const char* p, size_t n){
+    unsigned v = 0;
+    for(size_t i = 0; i < n; i++){
+        char c = p[i];
+        v <<= 4;
+        if(c >= '0' && c <= '9') v |= c - '0';
+        else if(c >= 'a' && c <= 'f') v |= c - 'a' + 10;
+        else if(c >= 'A' && c <= 'F') v |= c - 'A' + 10;
+        else throw parse_exception("invalid hex digit in escape");
+    }
+    return v;
+}
+
+inline void put_utf8(std::string& out, unsigned cp){
+    if(cp < 0x80){
+        out += (char)cp;
+    } else if(cp < 0x800){
+        out += (char)(0xC0 | (cp >> 6));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else if(cp < 0x10000){
+        out += (char)(0xE0 | (cp >> 12));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else {
+        out += (char)(0xF0 | (cp >> 18));
+        out += (char)(0x80 | ((cp >> 12) & 0x3F));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+// Resolve the escapes of double-quoted content into out (reused storage)
+
+inline std::string_view unescape(std::string_view s, std::string& out){
+
+    out.clear();
+    const char* p = s.data();
+    const char* end = p + s.size();
+
+    while(true){
+
+        const char* q = scan<false, '\\'>(p, end);
+        out.append(p, q - p);
+        if(q == end)
+            return out;
+
+        if(end - q < 2)
+            throw parse_exception("incomplete escape");
+
+        p = q + 2;
+        switch(q[1]){
+            case '"':  out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/':  out += '/'; break;
+            case 'n':  out += '\n'; break;
+            case 't':  out += '\t'; break;
+            case 'r':  out += '\r'; break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case '0':  out += '\0'; break;
+            case 'x': {
+                if(end - p < 2)
+                    throw parse_exception("incomplete escape");
+                out += (char)parse_hex(p, 2);
+                p += 2;
+                break;
+            }
+            case 'u': {
+                if(end - p < 4)
+                    throw parse_exception("incomplete escape");
+                unsigned cp = parse_hex(p, 4);
+                p += 4;
+                if(cp >= 0xD800 && cp < 0xDC00){
+                    if(end - p < 6 || p[0] != '\\' || p[1] != 'u')
+                        throw parse_exception("unpaired surrogate");
+                    unsigned lo = parse_hex(p + 2, 4);
+                    if(lo < 0xDC00 || lo >= 0xE000)
+                        throw parse_exception("unpaired surrogate");
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    p += 6;
+                }
+                put_utf8(out, cp);
+                break;
+            }
+            default:
+                throw parse_exception(std::string("invalid escape: \\") + q[1]);
+        }
+
+    }
+
+}
+
+// Only content which contains escapes needs the slow path
+
+inline std::string_view resolve(std::string_view s, std::string& scratch){
+    if(scan<false, '\\'>(s.data(), s.data() + s.size()) == s.data() + s.size())
+        return s;
+    return unescape(s, scratch);
+}
+
+}   // end of namespace escape
+}   // end of namespace ctom
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef CTOM_FRAME
+#define CTOM_FRAME
+
+#include "ctom.hpp"
+#include "json.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <poll.h>
+#include <unistd.h>
+
+namespace ctom {
+namespace frame {
+
+/*
+================================================================================
+                        Length-Prefixed Record Streams
+================================================================================
+Records are exchanged over file descriptors (pipes, sockets) as frames: a
+4-byte little-endian payload length, followed by the record as compact json.
+
+  ctom::frame::writer out(fd);
+  for(auto& r: records)
+    out.put(r);             // buffered, written in batches
+  out.flush();
+
+  ctom::frame::reader in(fd);
+  while(in.next(r))         // one record at a time
+    ...
+
+Writers collect frames and write many of them per syscall. Readers read as
+much as is available per syscall and parse every complete frame in place,
+directly from their receive buffer.
+
+Syscall errors throw std::system_error, malformed streams a parse_exception.
+*/
+
+constexpr size_t header = 4;
+
+inline void put_length(char* p, uint32_t n){
+    for(size_t i = 0; i < header; i++)
+        p[i] = (char)(n >> (8*i));
+}
+
+inline uint32_t get_length(const char* p){
+    uint32_t n = 0;
+    for(size_t i = 0; i < header; i++)
+        n |= (uint32_t)(unsigned char)p[i] << (8*i);
+    return n;
+}
+
+// Block until a non-blocking descriptor is ready
+
+inline void wait(int fd, short events){
+    pollfd p{fd, events, 0};
+    while(::poll(&p, 1, -1) < 0 && errno == EINTR);
+}
+
+/*
+================================================================================
+                                Frame Writer
+================================================================================
+Frames are emitted directly into the write buffer, the length is filled in
+afterwards. The buffer is written once it holds batch bytes, and on flush.
+*/
+
+struct writer {
+
+    // Appends to the write buffer, no intermediate copy
+
+    struct appendbuf: std::streambuf {
+        std::string& out;
+        appendbuf(std::string& out):out(out){}
+        int overflow(int c) override {
+            if(c != EOF) out.push_back((char)c);
+            return c;
+        }
+        std::streamsize xsputn(const char* p, std::streamsize n) override {
+            out.append(p, n);
+            return n;
+        }
+    };
+
+    int fd;
+    size_t batch;           // buffered bytes which trigger a write
+    size_t frames = 0;      // frames put
+    size_t calls = 0;       // write syscalls
+
+    std::string data;       // write buffer
+    appendbuf buf;
+    std::ostream os;
+    json::context ctx;
+
+    writer(int fd, size_t batch = 1 << 16):fd(fd),batch(batch),buf(data),os(&buf){
+        data.reserve(batch + (batch >> 2));
+    }
+
+    ~writer(){
+        try {
+            flush();
+        } catch(...){}
+    }
+
+    template<typename T>
+    void put(T& type){
+
+        size_t begin = data.size();
+        data.append(header, '\0');
+        os << json::emit(ctx, COMPACT) << type;
+
+        size_t n = data.size() - begin - header;
+        if(n > UINT32_MAX){
+            data.resize(begin);
+            throw parse_exception("frame too large");
+        }
+
+        put_length(data.data() + begin, (uint32_t)n);
+        frames++;
+
+        if(data.size() >= batch)
+            flush();
+
+    }
+
+    void flush(){
+        size_t done = 0;
+        while(done < data.size()){
+            auto n = ::write(fd, data.data() + done, data.size() - done);
+            if(n < 0){
+                if(errno == EINTR)
+                    continue;
+                if(errno == EAGAIN || errno == EWOULDBLOCK){
+                    wait(fd, POLLOUT);
+                    continue;
+                }
+                data.erase(0, done);
+                throw std::system_error(errno, std::generic_category(), "ctom::frame::writer");
+            }
+            calls++;
+            done += n;
+        }
+        data.clear();
+    }
+
+};
+
+/*
+================================================================================
+                                Frame Reader
+================================================================================
+The receive buffer is reused cyclically: parsed frames are released from its
+front, and before every read the (at most one) partial frame is moved back
+to the start. Frames therefore stay contiguous and are parsed in place;
+the buffer only grows for a frame larger than itself.
+*/
+
+struct reader {
+
+    int fd;
+    size_t max_frame;       // larger frames are rejected
+    size_t frames = 0;      // frames read
+    size_t calls = 0;       // read syscalls
+
+    std::unique_ptr<char[]> data;
+    size_t size;
+    size_t head = 0;        // first unparsed byte
+    size_t tail = 0;        // end of received bytes
+    bool done = false;      // end of stream received
+
+    json::context ctx;
+
+    reader(int fd, size_t capacity = 1 << 16, size_t max_frame = 1 << 24)
+    :fd(fd),max_frame(max_frame),data(new char[capacity]),size(capacity){}
+
+    // Next record: false at the end of the stream,
+    //  or (non-blocking descriptors) if no complete frame is available yet.
+
+    template<typename T>
+    bool next(T& type){
+        std::string_view payload;
+        if(!frame(payload))
+            return false;
+        json::parse_text(payload, type, ctx);
+        return true;
+    }
+
+    bool eof() const {
+        return done && head == tail;
+    }
+
+    // Next complete frame, valid until the next call
+
+    bool frame(std::string_view& payload){
+        while(true){
+
+            size_t have = tail - head;
+            size_t need = header;
+
+            if(have >= header){
+                size_t n = get_length(data.get() + head);
+                if(n > max_frame)
+                    throw parse_exception("frame too large: " + std::to_string(n) + " bytes");
+                need = header + n;
+                if(have >= need){
+                    payload = std::string_view(data.get() + head + header, n);
+                    head += need;
+                    frames++;
+                    return true;
+                }
+            }
+
+            if(done){
+                if(have > 0)
+                    throw parse_exception("truncated frame at end of stream");
+                return false;
+            }
+
+            if(!fill(need))
+                return false;
+
+        }
+    }
+
+    // Receive at least one more byte of a frame of need bytes
+
+    bool fill(size_t need){
+
+        size_t have = tail - head;
+        if(need > size){
+            size_t grown = std::max(need, 2*size);
+            std::unique_ptr<char[]> next(new char[grown]);
+            std::memcpy(next.get(), data.get() + head, have);
+            data = std::move(next);
+            size = grown;
+        }
+        else if(head > 0)
+            std::memmove(data.get(), data.get() + head, have);
+        head = 0;
+        tail = have;
+
+        while(true){
+            auto n = ::read(fd, data.get() + tail, size - tail);
+            if(n < 0){
+                if(errno == EINTR)
+                    continue;
+                if(errno == EAGAIN || errno == EWOULDBLOCK)
+                    return false;
+                throw std::system_error(errno, std::generic_category(), "ctom::frame::reader");
+            }
+            calls++;
+            if(n == 0) done = true;
+            tail += n;
+            return true;
+        }
+
+    }
+
+};
+
+}   // end of namespace frame
+}   // end of namespace ctom
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef CTOM_INSTANCE
+#define CTOM_INSTANCE
+
+#include "ctom.hpp"
+#include "yaml.hpp"
+#include "json.hpp"
+
+/*
+================================================================================
+                        Explicit Model Instantiation
+================================================================================
+Every translation unit which emits or parses a model instantiates the whole
+recursive emitter / parser for it. Instead, a model can be compiled once:
+
+  // config.hpp, next to the rule of the model
+  CTOM_EXTERN(config)
+
+  // config.cpp, in exactly one translation unit
+  CTOM_INSTANTIATE(config)
+
+CTOM_EXTERN declares the yaml and json entry points of the model as explicit
+instantiations (extern template), so including translation units only call
+them. CTOM_INSTANTIATE defines them. Both take the model type, which may
+contain commas, and are used at global scope.
+
+Only the entry points for the model itself are covered: emitting or parsing
+a member, or a container of models, is instantiated where it is used.
+*/
+
+#define CTOM_TEMPLATES(spec, ...) \
+    spec ctom::yaml::ostream ctom::yaml::operator<< <__VA_ARGS__>(ctom::yaml::ostream const&, __VA_ARGS__&); \
+    spec void ctom::yaml::operator>> <__VA_ARGS__>(ctom::yaml::istream, __VA_ARGS__&); \
+    spec void ctom::yaml::parse_text<__VA_ARGS__>(std::string_view, __VA_ARGS__&, ctom::yaml::context&); \
+    spec ctom::document ctom::yaml::load<__VA_ARGS__>(std::istream&, __VA_ARGS__&); \
+    spec ctom::json::ostream ctom::json::operator<< <__VA_ARGS__>(ctom::json::ostream const&, __VA_ARGS__&); \
+    spec void ctom::json::operator>> <__VA_ARGS__>(ctom::json::istream, __VA_ARGS__&); \
+    spec void ctom::json::parse_text<__VA_ARGS__>(std::string_view, __VA_ARGS__&, ctom::json::context&); \
+    spec ctom::document ctom::json::load<__VA_ARGS__>(std::istream&, __VA_ARGS__&);
+
+#define CTOM_EXTERN(...) CTOM_TEMPLATES(extern template, __VA_ARGS__)
+#define CTOM_INSTANTIATE(...) CTOM_TEMPLATES(template, __VA_ARGS__)
+
+#endif
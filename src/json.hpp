@@ -2,6 +2,11 @@
 #define CTOM_JSON
 
 #include "ctom.hpp"
+#include "escape.hpp"
+#include "scalar.hpp"
+#include "enum.hpp"
+#include "variant.hpp"
+#include "trace.hpp"
 
 #include <string>
 #include <string_view>
@@ -11,20 +16,6 @@
 namespace ctom {
 namespace json {
 
-struct ostream_json: ctom::ostream_base{} static emit;
-struct istream_json: ctom::istream_base{} static parse;
-
-using ostream = ctom::ostream<ostream_json>;
-using istream = ctom::istream<istream_json>;
-
-ostream operator<<(std::ostream& os, ostream_json&) {
-    return ostream(os);
-}
-
-istream operator>>(std::istream& is, istream_json&) {
-    return istream(is);
-}
-
 /*
 ================================================================================
                             JSON Model Co-State
@@ -38,33 +29,49 @@ enum indentstate {
     DASH
 };
 
-struct indent {
-    std::vector<indentstate> state;
-    indent(){}
-    indent(std::initializer_list<indentstate> s){
-        state = s;
-    }
+using context = ctom::context<indentstate>;
+using exception = ctom::exception;
+
+// Stream Modifiers
+//  emit(ctx) reuses an explicit context, otherwise a thread-local
+//  default context is used. emit(ctom::COMPACT) minifies the output.
+//  parse(doc) reads into a document handle, which std::string_view values point into.
+
+struct ostream_json: ctom::ostream_base{
+    typedef json::context context;
+    context* ctx = NULL;
+    format fmt = PRETTY;
+    ostream_json operator()(format f) const { return {{}, NULL, f}; }
+    ostream_json operator()(context& c, format f = PRETTY) const { return {{}, &c, f}; }
+} inline emit;
+
+struct istream_json: ctom::istream_base{
+    typedef json::context context;
+    context* ctx = NULL;
+    document* doc = NULL;
+    istream_json operator()(context& c) const { return {{}, &c, NULL}; }
+    istream_json operator()(document& d) const { return {{}, NULL, &d}; }
+    istream_json operator()(context& c, document& d) const { return {{}, &c, &d}; }
+} inline parse;
 
-    std::string to_string(){
-        std::string str = "";
-        for(auto& s: state){
-            if(s == TAB) str = str+"  ";
-            if(s == DASH) str = str+"- ";
-        }
-        return str;
-    }
-};
+using ostream = ctom::ostream<ostream_json>;
+using istream = ctom::istream<istream_json>;
+
+inline ostream operator<<(std::ostream& os, ostream_json const& m) {
+    return ostream(os, (m.ctx != NULL) ? *m.ctx : ctom::local<context>(), m.fmt);
+}
 
-indent operator+(indent ind, indentstate state){
-    ind.state.push_back(state);
-    return ind;
+inline istream operator>>(std::istream& is, istream_json const& m) {
+    auto& ctx = (m.ctx != NULL) ? *m.ctx : ctom::local<context>();
+    ctx.target = m.doc;
+    return istream(is, ctx);
 }
 
 // Reference State
 
 template<typename T>
 struct set {
-    indent ind;
+    size_t depth;
     const char* key;
     T* t;
     bool last = true;
@@ -72,8 +79,60 @@ struct set {
 
 template<typename T>
 ostream operator<<(ostream const& os, T& type){
-    typename rule<T>::type ref(type);
-    return os << set{{}, NULL, &ref};
+    bind<T> ref(type);
+    CTOM_TRACE1(emit_begin, "json");
+    os << set{0, NULL, &ref.impl};
+    CTOM_TRACE1(emit_end, "json");
+    return os;
+}
+
+// Parse of the Root Node (Traced); only whitespace may follow it
+
+inline void end_root(istream& ifs);
+
+template<typename T>
+void parse_root(istream& is, T& impl){
+    CTOM_TRACE2(parse_begin, "json", is.ctx.text.size());
+    try {
+        is >> set{0, NULL, &impl};
+        end_root(is);
+    } catch(exception e){
+        CTOM_TRACE4(parse_error, "json", trace::offset(is.ctx), is.ctx.line, e.what());
+        throw;
+    }
+    CTOM_TRACE3(parse_end, "json", is.ctx.text.size(), is.ctx.line);
+}
+
+template<typename T>
+void operator>>(istream is, T& type){
+    bind<T> ref(type);
+    ctom::read(is.is, is.ctx);
+    is.ctx.line = 1;
+    parse_root(is, ref.impl);
+}
+
+// Parse into a new document handle, which owns all string views of type
+
+template<typename T>
+document load(std::istream& is, T& type){
+    document doc;
+    is >> parse(doc) >> type;
+    return doc;
+}
+
+// Parse a text in place: it is not copied into the context,
+//  so it only has to outlive the call.
+
+template<typename T>
+void parse_text(std::string_view text, T& type, context& ctx = ctom::local<context>()){
+    static thread_local std::istream none(NULL);
+    bind<T> ref(type);
+    ctx.target = NULL;
+    ctx.text = text;
+    ctx.src = text;
+    ctx.line = 1;
+    istream is(none, ctx);
+    parse_root(is, ref.impl);
 }
 
 /*
@@ -82,41 +141,110 @@ ostream operator<<(ostream const& os, T& type){
 ================================================================================
 */
 
+// Formatting Helpers; Compact Output has no Insignificant Whitespace
+
+inline void put_indent(ostream const& os, size_t depth){
+    if(os.fmt == COMPACT)
+        return;
+    for(size_t d = 0; d < depth; d++)
+        os.os.write("  ", 2);
+}
+
+inline void put_key(ostream const& os, const char* key){
+    if(key == NULL)
+        return;
+    os.os.put('"');
+    escape::put_escaped(os.os, key);
+    os.os.write("\":", 2);
+    if(os.fmt == PRETTY)
+        os.os << " ";
+}
+
+inline void put_open(ostream const& os, char c){
+    os.os << c;
+    if(os.fmt == PRETTY)
+        os.os << "\n";
+}
+
+inline void put_end(ostream const& os, bool last){
+    if(!last) os.os << ",";
+    if(os.fmt == PRETTY)
+        os.os << "\n";
+}
+
+// Typed Values: Unquoted Numbers and Bools, Escaped Strings
+
+template<typename T>
+void put_val(ostream const& os, T& t){
+    if constexpr(std::is_same_v<T, bool>)
+        os.os << (t ? "true" : "false");
+    else if constexpr(std::is_floating_point_v<T>){
+        if(std::isfinite(t)) emit_number(os.os, t);
+        else os.os << "null";
+    }
+    else if constexpr(number_t<T>)
+        emit_number(os.os, t);
+    else if constexpr(std::is_convertible_v<T&, std::string_view>){
+        os.os.put('"');
+        escape::put_escaped(os.os, t);
+        os.os.put('"');
+    }
+    else if constexpr(std::is_same_v<T, char>){
+        os.os.put('"');
+        escape::put_escaped(os.os, std::string_view(&t, 1));
+        os.os.put('"');
+    }
+    else os.os << "\"" << t << "\"";
+}
+
+// Value Nodes: Enums by Name
+
+template<val_t T>
+void put_node(ostream const& os, T& node){
+    if constexpr(enum_t<T>){
+        auto name = T::name(*node.value);
+        auto num = +(typename T::U)*node.value;
+        if(name.empty()) put_val(os, num);
+        else put_val(os, name);
+    }
+    else put_val(os, *node.value);
+}
+
 template<val_t T>
 ostream operator<<(ostream const& os, set<T> s){
 
-    os.os << s.ind.to_string();
-    
-    if(s.key != NULL)
-        os.os << "\"" << s.key << "\": ";
-    
-    if(s.t != NULL) os.os << "\"" << *s.t->value << "\"";
-    else os.os << "\"\"";
+    put_indent(os, s.depth);
+    put_key(os, s.key);
 
-    if(!s.last) os.os << ",";
-    os.os << "\n";
+    if(s.t != NULL) put_node(os, *s.t);
+    else os.os << "null";
 
+    put_end(os, s.last);
     return os;
 }
 
 template<arr_t T>
 ostream operator<<(ostream const& os, set<T> s){
 
-    os.os << s.ind.to_string();
+    put_indent(os, s.depth);
+    put_key(os, s.key);
 
-    if(s.key != NULL)
-        os.os << "\"" << s.key << "\": ";
-    os.os << "[\n";
+    if(s.t == NULL){
+        os.os << "null";
+        put_end(os, s.last);
+        return os;
+    }
 
-    int n = 0;
+    put_open(os, '[');
+
+    size_t n = 0;
     s.t->for_refs([&](auto&& ref){
-        os << set{s.ind+TAB, NULL, ref.node.impl, (n == s.t->size-1)};
-        n++;
+        os << set{s.depth + 1, NULL, ref.node.impl, (++n == s.t->size)};
     });
 
-    os.os << s.ind.to_string() << "]";
-    if(!s.last) os.os << ",";
-    os.os << "\n";
+    put_indent(os, s.depth);
+    os.os << "]";
+    put_end(os, s.last);
 
     return os;
 }
@@ -124,26 +252,514 @@ ostream operator<<(ostream const& os, set<T> s){
 template<obj_t T>
 ostream operator<<(ostream const& os, set<T> s){
 
-    os.os << s.ind.to_string();
-    if(s.key != NULL)
-        os.os << "\"" << s.key << "\": ";
-    os.os << "{\n";
+    put_indent(os, s.depth);
+    put_key(os, s.key);
+
+    if(s.t == NULL){
+        os.os << "null";
+        put_end(os, s.last);
+        return os;
+    }
+
+    put_open(os, '{');
 
-    int n = 0;
+    size_t n = 0;
     s.t->for_refs([&](auto&& ref){
-        os << set{s.ind+TAB, ref.key, ref.node.impl, (n == s.t->size-1)};
-        n++;
+        os << set{s.depth + 1, ref.key, ref.node.impl, (++n == s.t->size)};
     });
 
-    os.os << s.ind.to_string() << "}";
-    if(!s.last) os.os << ",";
-    os.os << "\n";
+    put_indent(os, s.depth);
+    os.os << "}";
+    put_end(os, s.last);
+
+    return os;
+
+}
+
+// Tagged Unions: the active alternative, tag first
+
+template<var_t T>
+ostream operator<<(ostream const& os, set<T> s){
+
+    put_indent(os, s.depth);
+    put_key(os, s.key);
+
+    if(s.t == NULL){
+        os.os << "null";
+        put_end(os, s.last);
+        return os;
+    }
+
+    put_open(os, '{');
+
+    auto name = T::name(s.t->value->index());
+    std::visit([&](auto& alt){
+
+        bind<std::decay_t<decltype(alt)>> ref(alt);
+
+        put_indent(os, s.depth + 1);
+        put_key(os, T::tag.data());
+        put_val(os, name);
+        put_end(os, ref.impl.size == 0);
+
+        size_t n = 0;
+        ref.impl.for_refs([&](auto&& r){
+            os << set{s.depth + 1, r.key, r.node.impl, (++n == ref.impl.size)};
+        });
+
+    }, *s.t->value);
+
+    put_indent(os, s.depth);
+    os.os << "}";
+    put_end(os, s.last);
 
     return os;
 
 }
 
-}   // end of namespace yaml
+template<map_t T>
+ostream operator<<(ostream const& os, set<T> s){
+
+    put_indent(os, s.depth);
+    put_key(os, s.key);
+
+    if(s.t == NULL) os.os << "null";
+    else if(s.t->value->empty()) os.os << "{}";
+    else {
+
+        put_open(os, '{');
+
+        size_t n = 0;
+        size_t size = s.t->value->size();
+        s.t->for_entries(os.ctx.order, [&](auto& entry){
+            bind<typename T::mapped_type> ref(entry.second);
+            os << set{s.depth + 1, entry.first.c_str(), &ref.impl, (++n == size)};
+        });
+
+        put_indent(os, s.depth);
+        os.os << "}";
+
+    }
+
+    put_end(os, s.last);
+    return os;
+
+}
+
+template<seq_t T>
+ostream operator<<(ostream const& os, set<T> s){
+
+    put_indent(os, s.depth);
+    put_key(os, s.key);
+
+    if(s.t == NULL) os.os << "null";
+    else if(s.t->size() == 0) os.os << "[]";
+    else {
+
+        put_open(os, '[');
+
+        size_t size = s.t->size();
+        for(size_t n = 0; n < size; n++)
+            os << set{s.depth + 1, NULL, &s.t->at(n), (n + 1 == size)};
+
+        put_indent(os, s.depth);
+        os.os << "]";
+
+    }
+
+    put_end(os, s.last);
+    return os;
+
+}
+
+/*
+================================================================================
+                        JSON Unmarshal Implementation
+================================================================================
+*/
+
+// Stream Base-Operations
+
+inline void skip_whitespace(istream& ifs){
+    auto& src = ifs.ctx.src;
+    while(!src.empty()){
+        char c = src.front();
+        if(c == '\n') ifs.ctx.line++;
+        else if(c != ' ' && c != '\t' && c != '\r') return;
+        src.remove_prefix(1);
+    }
+}
+
+inline void end_root(istream& ifs){
+    skip_whitespace(ifs);
+    if(!ifs.ctx.src.empty())
+        throw exception(ifs.ctx.line, std::string("unexpected content after the root value: '") + ifs.ctx.src.front() + "'");
+}
+
+inline char peek(istream& ifs){
+    skip_whitespace(ifs);
+    if(ifs.ctx.src.empty())
+        throw exception(ifs.ctx.line, "unexpected eof");
+    return ifs.ctx.src.front();
+}
+
+inline void expect(istream& ifs, char c){
+    if(peek(ifs) != c)
+        throw exception(ifs.ctx.line, std::string("expected '") + c + "', have '" + ifs.ctx.src.front() + "'");
+    ifs.ctx.src.remove_prefix(1);
+}
+
+// Consume a separator (true) or the closing bracket (false)
+
+inline bool next(istream& ifs, char close){
+    char c = peek(ifs);
+    if(c != ',' && c != close)
+        throw exception(ifs.ctx.line, std::string("expected ',' or '") + close + "', have '" + c + "'");
+    ifs.ctx.src.remove_prefix(1);
+    return c == ',';
+}
+
+// Quoted String (Raw Content w.o. Quotes, Escapes Unresolved)
+//  Clean runs are skipped by the vectorized scan, which stops at quotes,
+//  backslashes and the (invalid) raw control characters.
+
+inline std::string_view get_string(istream& ifs){
+    expect(ifs, '"');
+    auto& src = ifs.ctx.src;
+    auto begin = src.data();
+    auto end = begin + src.size();
+    auto p = begin;
+    while(true){
+        p = escape::scan<true, '"', '\\'>(p, end);
+        if(p == end || *p == '\n')
+            throw exception(ifs.ctx.line, "unterminated string");
+        if(*p == '"')
+            break;
+        if(*p != '\\')
+            throw exception(ifs.ctx.line, "control character in string");
+        p += 2;
+        if(p > end)
+            throw exception(ifs.ctx.line, "unterminated string");
+    }
+    auto str = src.substr(0, p - begin);
+    src.remove_prefix(p - begin + 1);
+    return str;
+}
+
+// Quoted String w. Resolved Escapes (Scratch Storage)
+
+inline std::string_view get_text(istream& ifs){
+    auto str = get_string(ifs);
+    try {
+        return escape::resolve(str, ifs.ctx.esc);
+    } catch(parse_exception e){
+        throw exception(ifs.ctx.line, std::string("invalid string: ") + e.what());
+    }
+}
+
+// Unquoted Literal (Number, true, false, null)
+
+inline std::string_view get_literal(istream& ifs){
+    peek(ifs);
+    auto& src = ifs.ctx.src;
+    auto n = src.find_first_of(",:[]{} \t\r\n");
+    if(n == std::string_view::npos)
+        n = src.size();
+    if(n == 0)
+        throw exception(ifs.ctx.line, std::string("expected value, have '") + src.front() + "'");
+    auto lit = src.substr(0, n);
+    src.remove_prefix(n);
+    return lit;
+}
+
+inline bool get_null(istream& ifs){
+    if(peek(ifs) != 'n')
+        return false;
+    auto lit = get_literal(ifs);
+    if(lit != "null")
+        throw exception(ifs.ctx.line, std::string("invalid literal: ") + std::string(lit));
+    return true;
+}
+
+// Fast Subtree Skipping
+//  Tracks bracket depth and strings only: no value conversion, no allocation.
+
+inline void skip_value(istream& ifs){
+
+    char c = peek(ifs);
+    if(c == '"'){
+        get_string(ifs);
+        return;
+    }
+    if(c != '{' && c != '['){
+        get_literal(ifs);
+        return;
+    }
+
+    auto& src = ifs.ctx.src;
+    size_t depth = 0;
+    size_t n = 0;
+    while(true){
+
+        n = src.find_first_of("\"{}[]\n", n);
+        if(n == std::string_view::npos)
+            throw exception(ifs.ctx.line, "unexpected eof");
+
+        switch(src[n]){
+            case '\n':
+                ifs.ctx.line++;
+                break;
+            case '"':
+                while(true){
+                    n = src.find_first_of("\"\\", n + 1);
+                    if(n == std::string_view::npos)
+                        throw exception(ifs.ctx.line, "unterminated string");
+                    if(src[n] == '"') break;
+                    n++;
+                }
+                break;
+            case '{':
+            case '[':
+                depth++;
+                break;
+            default:
+                if(--depth == 0){
+                    src.remove_prefix(n + 1);
+                    return;
+                }
+        }
+        n++;
+
+    }
+
+}
+
+// Unmarshal Implementation
+
+template<val_t T>
+void operator>>(istream& stream, set<T> s){
+
+    bool quoted = (peek(stream) == '"');
+    auto val = quoted ? get_text(stream) : get_literal(stream);
+
+    if(!quoted && val == "null")
+        return;
+
+    if(s.t != NULL)
+    try {
+        parse_node(*s.t, val, stream.ctx);
+    } catch(parse_exception e){
+        throw exception(stream.ctx.line, std::string("failed to parse value: ") + e.what());
+    }
+
+}
+
+template<arr_t T>
+void operator>>(istream& stream, set<T> s){
+
+    if(s.t == NULL)
+        return skip_value(stream);
+
+    if(get_null(stream))
+        return;
+
+    expect(stream, '[');
+
+    size_t n = 0;
+    s.t->for_refs([&](auto&& ref){
+        if(n++ > 0) expect(stream, ',');
+        stream >> set{s.depth + 1, NULL, ref.node.impl};
+    });
+
+    expect(stream, ']');
+
+}
+
+// One member, dispatched by key;
+//  unknown members and the member named skip (a tag) are skipped.
+
+template<obj_t T>
+void parse_member(istream& stream, set<T> s, std::string_view skip = {}, std::bitset<T::size>* seen = NULL){
+
+    auto key = get_string(stream);
+    expect(stream, ':');
+
+    if(!skip.empty() && key == skip)
+        return skip_value(stream);
+
+    bool found = false;
+    size_t n = 0;
+    s.t->for_refs([&](auto&& ref){
+        if(found || key != std::string_view(ref.key)){
+            n++;
+            return;
+        }
+        found = true;
+        if(seen != NULL)
+            seen->set(n);
+        stream >> set{s.depth + 1, ref.key, ref.node.impl};
+    });
+
+    if(found)
+        return;
+
+    if(stream.ctx.strict)
+        throw exception(stream.ctx.line, std::string("unexpected key: \"") + std::string(key) + "\"");
+
+    skip_value(stream);
+
+}
+
+// Members in any order; all bound keys are required
+
+template<obj_t T>
+void parse_members(istream& stream, set<T> s, std::string_view skip = {}){
+
+    std::bitset<T::size> seen;
+    expect(stream, '{');
+    if(peek(stream) == '}')
+        stream.ctx.src.remove_prefix(1);
+    else do {
+        parse_member(stream, s, skip, &seen);
+    } while(next(stream, '}'));
+
+    if(auto key = s.t->missing(seen))
+        throw exception(stream.ctx.line, std::string("missing key: \"") + key + "\"");
+
+}
+
+template<obj_t T>
+void operator>>(istream& stream, set<T> s){
+
+    if(s.t == NULL)
+        return skip_value(stream);
+
+    if(get_null(stream))
+        return;
+
+    CTOM_TRACE_OBJECT("json", s.key, stream.ctx);
+    parse_members(stream, s);
+
+}
+
+// Tag of the object ahead, without consuming it:
+//  other members are skipped unconverted.
+
+inline std::string_view peek_tag(istream& stream, std::string_view tag){
+
+    auto src = stream.ctx.src;
+    auto line = stream.ctx.line;
+
+    std::string_view val;
+    bool found = false;
+
+    expect(stream, '{');
+    if(peek(stream) != '}')
+    do {
+        auto key = get_string(stream);
+        expect(stream, ':');
+        if(key == tag){
+            val = get_text(stream);
+            found = true;
+            break;
+        }
+        skip_value(stream);
+    } while(next(stream, '}'));
+
+    stream.ctx.src = src;
+    stream.ctx.line = line;
+
+    if(!found)
+        throw exception(line, std::string("missing tag: \"") + std::string(tag) + "\"");
+    return val;
+
+}
+
+// Alternative Parsers, Indexed by Tag
+
+template<var_t T>
+struct parse_alt {
+    template<size_t I>
+    static void call(istream& stream, set<T> s){
+        auto& alt = s.t->template get<I>();
+        bind<std::decay_t<decltype(alt)>> ref(alt);
+        parse_members(stream, set{s.depth, NULL, &ref.impl}, T::tag);
+    }
+};
+
+template<var_t T>
+void operator>>(istream& stream, set<T> s){
+
+    if(s.t == NULL)
+        return skip_value(stream);
+
+    if(get_null(stream))
+        return;
+
+    CTOM_TRACE_OBJECT("json", s.key, stream.ctx);
+    auto name = peek_tag(stream, T::tag);
+    size_t index = T::table.find(name);
+    if(index == T::N)
+        throw exception(stream.ctx.line, std::string("unknown tag: \"") + std::string(name) + "\"");
+
+    static constexpr auto table = T::template dispatch<parse_alt<T>>();
+    table[index](stream, s);
+
+}
+
+template<map_t T>
+void operator>>(istream& stream, set<T> s){
+
+    if(s.t == NULL)
+        return skip_value(stream);
+
+    if(get_null(stream))
+        return;
+
+    expect(stream, '{');
+    if(peek(stream) == '}'){
+        stream.ctx.src.remove_prefix(1);
+        return;
+    }
+
+    s.t->reserve();
+
+    do {
+
+        auto key = get_text(stream);
+        expect(stream, ':');
+
+        auto& entry = s.t->entry(key, stream.ctx.buf);
+        bind<typename T::mapped_type> ref(entry.second);
+        stream >> set{s.depth + 1, entry.first.c_str(), &ref.impl};
+
+    } while(next(stream, '}'));
+
+}
+
+template<seq_t T>
+void operator>>(istream& stream, set<T> s){
+
+    if(s.t == NULL)
+        return skip_value(stream);
+
+    if(get_null(stream))
+        return;
+
+    expect(stream, '[');
+
+    size_t n = 0;
+    if(peek(stream) == ']')
+        stream.ctx.src.remove_prefix(1);
+    else do {
+        stream >> set{s.depth + 1, NULL, &s.t->slot(n++)};
+    } while(next(stream, ']'));
+
+    s.t->trim(n);
+
+}
+
+}   // end of namespace json
 }   // end of namespace ctom
 
 #endif
\ No newline at end of file
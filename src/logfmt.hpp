@@ -0,0 +1,329 @@
+#ifndef CTOM_LOGFMT
+#define CTOM_LOGFMT
+
+#include "ctom.hpp"
+#include "escape.hpp"
+#include "enum.hpp"
+#include "variant.hpp"
+
+#include <cstring>
+#include <string_view>
+#include <charconv>
+#include <vector>
+#include <variant>
+
+namespace ctom {
+namespace logfmt {
+
+/*
+================================================================================
+                        Structured Single-Line Logging
+================================================================================
+An object model is written as one logfmt line of key=value pairs, with nested
+keys flattened into dotted paths. Paths through objects are joined at compile
+time, array indices and dynamic keys are appended at run time:
+
+  method=GET path=/api status=200 timing.total=0.25 tags.0=a tags.1=b
+
+Lines are built in a fixed thread-local buffer and handed to a sink, so that
+logging an event does not allocate:
+
+  ctom::logfmt::log([](std::string_view line){ write(2, line.data(), line.size()); }, event);
+  std::cout << ctom::logfmt::emit << event;
+
+Pairs which do not fit into the buffer are dropped whole, and the line is
+ended with truncated=true.
+*/
+
+#ifndef CTOM_LOGFMT_LINE
+#define CTOM_LOGFMT_LINE 4096
+#endif
+
+// Line Buffer
+
+struct line {
+
+    static constexpr size_t capacity = CTOM_LOGFMT_LINE;
+    static constexpr size_t path_capacity = 256;
+    static constexpr std::string_view marker = " truncated=true";
+
+    char data[capacity];
+    size_t size = 0;
+    bool truncated = false;
+
+    char path[path_capacity];       // run-time part of the current key path
+    size_t path_size = 0;
+
+    std::vector<void const*> order; // scratch entry order (unordered maps)
+
+    void clear(){
+        size = 0;
+        path_size = 0;
+        truncated = false;
+    }
+
+    // Writes past the capacity (less the marker) are dropped
+
+    void put(const char* p, size_t n){
+        if(truncated || n > capacity - marker.size() - 1 - size){
+            truncated = true;
+            return;
+        }
+        std::memcpy(data + size, p, n);
+        size += n;
+    }
+
+    void put(std::string_view s){
+        put(s.data(), s.size());
+    }
+
+    void put(char c){
+        put(&c, 1);
+    }
+
+    std::string_view finish(){
+        if(truncated){
+            std::memcpy(data + size, marker.data(), marker.size());
+            size += marker.size();
+        }
+        data[size++] = '\n';
+        return std::string_view(data, size);
+    }
+
+};
+
+inline line& buffer(){
+    static thread_local line l;
+    return l;
+}
+
+// Compile-Time Key Paths
+//  Characters which would end a key (space, '=', '"', control) become '_'.
+
+constexpr bool key_char(char c){
+    return c > ' ' && c != '=' && c != '"' && c != 0x7F;
+}
+
+template<constexpr_string A, constexpr_string B>
+constexpr auto join(){
+    constexpr size_t N = (A.size() > 0 ? A.size() + 1 : 0) + B.size();
+    char v[N + 1] = {};
+    size_t n = 0;
+    for(char c: A) v[n++] = c;
+    if(A.size() > 0) v[n++] = '.';
+    for(char c: B) v[n++] = key_char(c) ? c : '_';
+    return constexpr_string<N>(v);
+}
+
+// Run-Time Key Path Segments
+
+inline void push(line& l, std::string_view s){
+    if(s.empty())
+        return;
+    if(l.path_size + s.size() + 1 > line::path_capacity){
+        l.truncated = true;
+        return;
+    }
+    if(l.path_size > 0)
+        l.path[l.path_size++] = '.';
+    for(char c: s)
+        l.path[l.path_size++] = key_char(c) ? c : '_';
+}
+
+inline void put_key(line& l, std::string_view name, std::string_view extra = {}){
+    l.put(l.path, l.path_size);
+    if(l.path_size > 0 && !name.empty()) l.put('.');
+    l.put(name);
+    if(!extra.empty()){
+        if(l.path_size > 0 || !name.empty()) l.put('.');
+        l.put(extra);
+    }
+    l.put('=');
+}
+
+/*
+================================================================================
+                                Value Emitter
+================================================================================
+Strings are written bare when they hold no space, '=', quote, backslash,
+control character or DEL, all others double-quoted with escapes.
+*/
+
+inline void put_string(line& l, std::string_view s){
+    auto end = s.data() + s.size();
+    if(!s.empty() && escape::scan<true, ' ', '=', '"', '\\', '\x7F'>(s.data(), end) == end){
+        l.put(s);
+        return;
+    }
+    l.put('"');
+    for(auto p = s.data(); p < end; ){
+        auto q = escape::scan<true, '"', '\\', '\x7F'>(p, end);
+        l.put(p, q - p);
+        if(q == end)
+            break;
+        switch(*q){
+            case '"':  l.put("\\\""); break;
+            case '\\': l.put("\\\\"); break;
+            case '\n': l.put("\\n"); break;
+            case '\t': l.put("\\t"); break;
+            case '\r': l.put("\\r"); break;
+            default: {
+                const char* hex = "0123456789abcdef";
+                char u[6] = {'\\', 'u', '0', '0', hex[(*q >> 4) & 0xF], hex[*q & 0xF]};
+                l.put(u, 6);
+            }
+        }
+        p = q + 1;
+    }
+    l.put('"');
+}
+
+template<typename T>
+void put_val(line& l, T& t){
+    if constexpr(std::is_same_v<T, bool>)
+        l.put(t ? std::string_view("true") : std::string_view("false"));
+    else if constexpr(number_t<T>){
+        char buf[64];
+        auto res = std::to_chars(buf, buf + sizeof(buf), t);
+        l.put(buf, res.ptr - buf);
+    }
+    else if constexpr(std::is_convertible_v<T&, std::string_view>)
+        put_string(l, t);
+    else if constexpr(std::is_same_v<T, char>)
+        put_string(l, std::string_view(&t, 1));
+    else static_assert(std::is_same_v<T, bool>, "value type has no logfmt form");
+}
+
+template<val_t T>
+void put_node(line& l, T& node){
+    if constexpr(enum_t<T>){
+        auto name = T::name(*node.value);
+        auto num = +(typename T::U)*node.value;
+        if(name.empty()) put_val(l, num);
+        else put_val(l, name);
+    }
+    else put_val(l, *node.value);
+}
+
+/*
+================================================================================
+                                Model Walk
+================================================================================
+Name is the compile-time part of the key path below the run-time part,
+which is extended (and reset) at every array, sequence or dynamic key.
+*/
+
+template<constexpr_string Name, val_t T>
+void put_pair(line& l, T& node){
+    size_t begin = l.size;
+    if(begin > 0) l.put(' ');
+    put_key(l, std::string_view(Name.value, Name.size()));
+    put_node(l, node);
+    if(l.truncated)
+        l.size = begin;
+}
+
+template<constexpr_string Name, typename T>
+void put(line& l, T& node);
+
+template<constexpr_string Name, typename T>
+void each(line& l, std::string_view label, T& node){
+    size_t base = l.path_size;
+    push(l, std::string_view(Name.value, Name.size()));
+    push(l, label);
+    put<"">(l, node);
+    l.path_size = base;
+}
+
+template<constexpr_string Name, typename T>
+void put(line& l, T& node){
+
+    if(l.truncated)
+        return;
+
+    if constexpr(val_t<T>)
+        put_pair<Name>(l, node);
+
+    else if constexpr(obj_t<T>)
+        node.for_refs([&](auto&& ref){
+            using R = std::decay_t<decltype(ref)>;
+            if(ref.node.impl != NULL)
+                put<join<Name, R::key>()>(l, *ref.node.impl);
+        });
+
+    else if constexpr(arr_t<T> || seq_t<T>){
+        char buf[24];
+        auto index = [&buf](size_t n){
+            auto res = std::to_chars(buf, buf + sizeof(buf), n);
+            return std::string_view(buf, res.ptr - buf);
+        };
+        if constexpr(arr_t<T>){
+            size_t n = 0;
+            node.for_refs([&](auto&& ref){
+                auto label = index(n++);
+                if(ref.node.impl != NULL)
+                    each<Name>(l, label, *ref.node.impl);
+            });
+        }
+        else for(size_t n = 0; n < node.size(); n++)
+            each<Name>(l, index(n), node.at(n));
+    }
+
+    else if constexpr(map_t<T>)
+        node.for_entries(l.order, [&](auto& entry){
+            bind<typename T::mapped_type> ref(entry.second);
+            each<Name>(l, entry.first, ref.impl);
+        });
+
+    else if constexpr(var_t<T>){
+        size_t begin = l.size;
+        if(begin > 0) l.put(' ');
+        put_key(l, std::string_view(Name.value, Name.size()), T::tag);
+        put_string(l, T::name(node.value->index()));
+        if(l.truncated)
+            l.size = begin;
+        std::visit([&](auto& alt){
+            bind<std::decay_t<decltype(alt)>> ref(alt);
+            put<Name>(l, ref.impl);
+        }, *node.value);
+    }
+
+}
+
+// Build the line of a model in the thread-local buffer and hand it to sink
+
+template<typename F, typename T>
+void log(F&& sink, T& type){
+    auto& l = buffer();
+    l.clear();
+    bind<T> ref(type);
+    using R = std::remove_reference_t<decltype(ref.impl)>;
+    static_assert(obj_t<R> || map_t<R> || var_t<R>, "a logfmt line is written from an object: its keys name the pairs");
+    put<"">(l, ref.impl);
+    sink(l.finish());
+}
+
+// Stream Modifier: writes the line to a std::ostream
+
+struct ostream_logfmt: ctom::ostream_base{} inline emit;
+
+struct ostream {
+    std::ostream& os;
+};
+
+inline ostream operator<<(std::ostream& os, ostream_logfmt const&){
+    return ostream{os};
+}
+
+template<typename T>
+std::ostream& operator<<(ostream const& os, T& type){
+    log([&os](std::string_view s){
+        os.os.write(s.data(), s.size());
+    }, type);
+    return os.os;
+}
+
+}   // end of namespace logfmt
+}   // end of namespace ctom
+
+#endif
@@ -0,0 +1,488 @@
+#ifndef CTOM_PARALLEL
+#define CTOM_PARALLEL
+
+#include "ctom.hpp"
+#include "yaml.hpp"
+#include "json.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace ctom {
+
+/*
+================================================================================
+                        Parallel Parse by Top-Level Subtree
+================================================================================
+A document whose root is an object, array or sequence is parsed in two passes:
+a cheap scan locates the top-level keys / items (by indentation for yaml, by
+bracket depth for json), then every top-level subtree is parsed on a worker:
+
+  is >> ctom::yaml::parse >> ctom::parallel(8) >> snapshot;
+  is >> ctom::json::parse(doc) >> ctom::parallel() >> snapshot;
+
+The result equals that of a sequential parse, including the reported error:
+the errors of all subtrees are collected, the first in document order is
+rethrown. Documents with a different root, a flow-collection root, repeated
+top-level keys, (arrays) the wrong number of items or (yaml) a line that is
+not a top-level key / item, and parses with an intern pool, are parsed
+sequentially. So are texts below parallel::min_text (64KiB) and parses with
+one hardware thread: the thread count is capped at the hardware's. A line within a subtree which its parse does not take (e.g. an
+overindented nested key) is an error, where the sequential parse would end
+the document there.
+
+Workers parse with their own contexts. string_view values point into the
+document text as usual; only unescaped values are stored, in per-worker arenas
+which move into the document handle once all workers have finished.
+*/
+
+struct parallel {
+    static constexpr size_t min_text = 1 << 16;     // smaller texts are parsed sequentially
+    size_t threads;         // 0: one per hardware thread
+    explicit parallel(size_t threads = 0):threads(threads){}
+};
+
+// Source of one top-level subtree
+
+struct segment {
+    std::string_view text;
+    size_t line;            // line count before the subtree
+    size_t index;           // position among the top-level subtrees
+};
+
+// Parse every segment with f(worker, segment) on up to threads workers;
+//  the first error in document order is rethrown once all have finished.
+
+template<typename F>
+void run_segments(std::vector<segment> const& segments, size_t workers, F&& f){
+
+    std::vector<std::exception_ptr> errors(segments.size());
+    std::atomic<size_t> next = 0;
+
+    auto work = [&](size_t w){
+        size_t n;
+        while((n = next.fetch_add(1, std::memory_order_relaxed)) < segments.size())
+        try {
+            f(w, segments[n]);
+        } catch(...){
+            errors[n] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for(size_t w = 1; w < workers; w++)
+        pool.emplace_back(work, w);
+    work(0);
+    for(auto& t: pool)
+        t.join();
+
+    for(auto& e: errors)
+    if(e != NULL)
+        std::rethrow_exception(e);
+
+}
+
+// Worker Contexts, Seeded from the Caller's
+
+template<typename C>
+struct workers {
+
+    std::vector<C> ctx;
+    std::vector<document> docs;     // unescaped string_view values per worker
+    document* target;
+
+    workers(C const& base, size_t n):ctx(n),target(base.target){
+        if(target != NULL)
+            docs.resize(n);
+        for(size_t w = 0; w < n; w++){
+            ctx[w].text = base.text;
+            ctx[w].strict = base.strict;
+            if(target == NULL)
+                continue;
+            docs[w].data->shared = target->data->text;
+            ctx[w].target = &docs[w];
+        }
+    }
+
+    C& at(size_t w, segment const& s){
+        ctx[w].src = s.text;
+        ctx[w].line = s.line;
+        return ctx[w];
+    }
+
+    // Values kept by the workers move into the caller's document
+
+    ~workers(){
+        if(target == NULL)
+            return;
+        auto& blocks = target->data->arena.blocks;
+        for(auto& d: docs)
+        for(auto& b: d.data->arena.blocks)
+            blocks.insert(blocks.begin(), std::move(b));
+    }
+
+};
+
+// Whether all bound keys of an object are top-level keys of the document:
+//  a missing key is reported by the sequential parse.
+
+template<obj_t T, typename S>
+bool all_keys(T& impl, S const& keys){
+    std::bitset<T::size> seen;
+    size_t n = 0;
+    impl.for_refs([&](auto&& ref){
+        if(keys.count(typename S::key_type(ref.key)) > 0)
+            seen.set(n);
+        n++;
+    });
+    return impl.missing(seen) == NULL;
+}
+
+// Workers for a text: at most one per hardware thread, and none to spare
+//  (1) below parallel::min_text, where the scan costs more than it saves
+
+inline size_t worker_limit(size_t threads, size_t text){
+    size_t cores = std::max<unsigned>(1, std::thread::hardware_concurrency());
+    if(text < parallel::min_text)
+        return 1;
+    return (threads == 0) ? cores : std::min(threads, cores);
+}
+
+/*
+================================================================================
+                              YAML Subtree Parse
+================================================================================
+Top-level keys and items are located with the parser's own subtree skipping,
+which follows indentation only and converts no values.
+*/
+
+namespace yaml {
+
+struct parallel_istream {
+    istream is;
+    size_t threads;
+};
+
+inline parallel_istream operator>>(istream is, ctom::parallel p){
+    return {is, p.threads};
+}
+
+// Node Type of a Top-Level Key / Item
+
+template<typename T>
+bool value_key(std::string_view key){
+    bool value = false;
+    T::for_type::iter([&]<typename Ref>(){
+        using N = std::remove_pointer_t<decltype(std::declval<Ref&>().node.impl)>;
+        if(key == std::string_view(Ref::key))
+            value = val_t<N>;
+    });
+    return value;
+}
+
+template<typename T>
+bool value_item(size_t index){
+    if constexpr(arr_t<T>){
+        bool value = false;
+        size_t n = 0;
+        T::for_type::iter([&]<typename Ref>(){
+            using N = std::remove_pointer_t<decltype(std::declval<Ref&>().node.impl)>;
+            if(n++ == index)
+                value = val_t<N>;
+        });
+        return value;
+    }
+    else return val_t<std::remove_reference_t<decltype(std::declval<bind<typename T::value_type>&>().impl)>>;
+}
+
+// Skip a top-level key (depth 0) or item (depth 1) as skip_key / skip_item
+//  do, in the same pass checking that its parse takes all skipped lines: it
+//  stops at any line after a value, and at a sequence at the key's column.
+
+inline bool skip_segment(istream& stream, size_t depth, bool value){
+
+    size_t column = 2*depth - (depth > 0);
+    auto line = get_line(stream);
+    trim_indent(stream, line, depth);
+
+    while(true){
+
+        auto src = stream.ctx.src;
+        auto line_n = stream.ctx.line;
+
+        std::string_view next;
+        if(!next_line(stream, next))
+            return true;
+
+        auto indent = next.find_first_not_of(' ');
+        bool dash = (indent == column && next.substr(indent).starts_with("- "));
+        if(indent > column || dash){
+            if(value || (dash && depth == 0))
+                return false;
+            continue;
+        }
+
+        stream.ctx.src = src;
+        stream.ctx.line = line_n;
+        return true;
+
+    }
+
+}
+
+template<typename T>
+bool split(istream& stream, std::vector<segment>& segments, T& impl){
+
+    auto& ctx = stream.ctx;
+    if(peek_flow(stream, 0))
+        return false;
+
+    if constexpr(obj_t<T>){
+        std::unordered_set<std::string> keys;
+        std::string_view key;
+        while(peek_key(stream, 0, key)){
+            if(!keys.emplace(key).second)
+                return false;
+            auto begin = ctx.src.data();
+            auto line = ctx.line;
+            if(!skip_segment(stream, 0, value_key<T>(key)))
+                return false;
+            segments.push_back({std::string_view(begin, ctx.src.data() - begin), line, segments.size()});
+        }
+        if(!all_keys(impl, keys))
+            return false;
+    }
+
+    else {
+        while(peek_item(stream, 0)){
+            ctx.at(0) = DASH;
+            auto begin = ctx.src.data();
+            auto line = ctx.line;
+            if(!skip_segment(stream, 1, value_item<T>(segments.size())))
+                return false;
+            segments.push_back({std::string_view(begin, ctx.src.data() - begin), line, segments.size()});
+        }
+        if constexpr(arr_t<T>)
+        if(segments.size() != T::size)
+            return false;
+    }
+
+    // The scan stops at the first line which is not a top-level key / item:
+    //  anything but comments after it is left to the sequential parse.
+
+    std::string_view line;
+    return !next_line(stream, line);
+
+}
+
+template<typename T>
+void parse_segment(istream& stream, T& impl, segment const& s){
+
+    if constexpr(obj_t<T>){
+        std::bitset<T::size> seen;      // missing keys are checked by split
+        parse_members(stream, set{0, NULL, &impl}, {}, seen);
+    }
+
+    else if constexpr(arr_t<T>){
+        size_t n = 0;
+        impl.for_refs([&](auto&& ref){
+            if(n++ != s.index) return;
+            stream.ctx.at(0) = DASH;
+            if(ref.node.impl == NULL)
+                skip_item(stream, 1);
+            else stream >> set{1, NULL, ref.node.impl};
+        });
+    }
+
+    else {
+        bind<typename T::value_type> ref((*impl.value)[s.index]);
+        stream.ctx.at(0) = DASH;
+        stream >> set{1, NULL, &ref.impl};
+    }
+
+}
+
+template<typename T>
+void operator>>(parallel_istream p, T& type){
+
+    bind<T> ref(type);
+    using R = std::remove_reference_t<decltype(ref.impl)>;
+
+    auto& is = p.is;
+    ctom::read(is.is, is.ctx);
+
+    std::vector<segment> segments;
+    size_t limit = worker_limit(p.threads, is.ctx.text.size());
+    bool split = false;
+    if constexpr(obj_t<R> || arr_t<R> || seq_t<R>)
+    if(limit > 1 && is.ctx.intern == NULL)
+    try {
+        split = yaml::split(is, segments, ref.impl);
+    } catch(exception e){
+        split = false;
+    }
+
+    size_t n = std::min(limit, segments.size());
+    if(!split || n < 2){
+        is.ctx.src = is.ctx.text;
+        is.ctx.line = 0;
+        return parse_root(is, ref.impl);
+    }
+
+    if constexpr(seq_t<R>){
+        for(size_t i = 0; i < segments.size(); i++)
+            ref.impl.slot(i);
+        ref.impl.trim(segments.size());
+    }
+
+    CTOM_TRACE2(parse_begin, "yaml", is.ctx.text.size());
+    workers<context> w(is.ctx, n);
+    run_segments(segments, n, [&](size_t k, segment const& s){
+        istream stream(is.is, w.at(k, s));
+        parse_segment(stream, ref.impl, s);
+        std::string_view line;
+        if(next_line(stream, line))
+            throw exception(stream.ctx.line, "invalid indent: unexpected line");
+    });
+    CTOM_TRACE3(parse_end, "yaml", is.ctx.text.size(), is.ctx.line);
+
+}
+
+}   // end of namespace yaml
+
+/*
+================================================================================
+                              JSON Subtree Parse
+================================================================================
+Top-level members and elements are located with the parser's own value
+skipping, which tracks bracket depth and strings only.
+*/
+
+namespace json {
+
+struct parallel_istream {
+    istream is;
+    size_t threads;
+};
+
+inline parallel_istream operator>>(istream is, ctom::parallel p){
+    return {is, p.threads};
+}
+
+template<typename T>
+bool split(istream& stream, std::vector<segment>& segments, T& impl){
+
+    auto& ctx = stream.ctx;
+    constexpr char open = obj_t<T> ? '{' : '[';
+    constexpr char close = obj_t<T> ? '}' : ']';
+
+    if(peek(stream) != open)
+        return false;
+    ctx.src.remove_prefix(1);
+
+    std::unordered_set<std::string_view> keys;
+    if(peek(stream) != close)
+    do {
+        peek(stream);
+        auto begin = ctx.src.data();
+        auto line = ctx.line;
+        if constexpr(obj_t<T>){
+            if(!keys.insert(get_string(stream)).second)
+                return false;
+            expect(stream, ':');
+        }
+        skip_value(stream);
+        segments.push_back({std::string_view(begin, ctx.src.data() - begin), line, segments.size()});
+    } while(next(stream, close));
+
+    if constexpr(obj_t<T>)
+    if(!all_keys(impl, keys))
+        return false;
+
+    if constexpr(arr_t<T>)
+    if(segments.size() != T::size)
+        return false;
+
+    // Content after the root is reported by the sequential parse
+
+    skip_whitespace(stream);
+    return ctx.src.empty();
+
+}
+
+template<typename T>
+void parse_segment(istream& stream, T& impl, segment const& s){
+
+    if constexpr(obj_t<T>)
+        parse_member(stream, set{0, NULL, &impl});
+
+    else if constexpr(arr_t<T>){
+        size_t n = 0;
+        impl.for_refs([&](auto&& ref){
+            if(n++ == s.index)
+                stream >> set{1, NULL, ref.node.impl};
+        });
+    }
+
+    else {
+        bind<typename T::value_type> ref((*impl.value)[s.index]);
+        stream >> set{1, NULL, &ref.impl};
+    }
+
+}
+
+template<typename T>
+void operator>>(parallel_istream p, T& type){
+
+    bind<T> ref(type);
+    using R = std::remove_reference_t<decltype(ref.impl)>;
+
+    auto& is = p.is;
+    ctom::read(is.is, is.ctx);
+    is.ctx.line = 1;
+
+    std::vector<segment> segments;
+    size_t limit = worker_limit(p.threads, is.ctx.text.size());
+    bool split = false;
+    if constexpr(obj_t<R> || arr_t<R> || seq_t<R>)
+    if(limit > 1 && is.ctx.intern == NULL)
+    try {
+        split = json::split(is, segments, ref.impl);
+    } catch(exception e){
+        split = false;
+    }
+
+    size_t n = std::min(limit, segments.size());
+    if(!split || n < 2){
+        is.ctx.src = is.ctx.text;
+        is.ctx.line = 1;
+        return parse_root(is, ref.impl);
+    }
+
+    if constexpr(seq_t<R>){
+        for(size_t i = 0; i < segments.size(); i++)
+            ref.impl.slot(i);
+        ref.impl.trim(segments.size());
+    }
+
+    CTOM_TRACE2(parse_begin, "json", is.ctx.text.size());
+    workers<context> w(is.ctx, n);
+    run_segments(segments, n, [&](size_t k, segment const& s){
+        istream stream(is.is, w.at(k, s));
+        parse_segment(stream, ref.impl, s);
+    });
+    CTOM_TRACE3(parse_end, "json", is.ctx.text.size(), is.ctx.line);
+
+}
+
+}   // end of namespace json
+}   // end of namespace ctom
+
+#endif
@@ -0,0 +1,309 @@
+#ifndef CTOM_PROM
+#define CTOM_PROM
+
+#include "ctom.hpp"
+#include "enum.hpp"
+#include "variant.hpp"
+
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <variant>
+
+namespace ctom {
+namespace prom {
+
+/*
+================================================================================
+                        Prometheus Text Exposition
+================================================================================
+An object model is written as one sample per numeric value. Metric names are
+the nested keys joined by '_', built at compile time. Array and sequence
+elements are labelled by index, dynamic-key entries by key:
+
+  struct Stats: ctom::obj<
+    ctom::key<"requests", int>,
+    ctom::key<"workers", ctom::arr<2, ctom::obj<ctom::key<"busy", int>>>>
+  >{ ... };
+
+  requests 12
+  workers_busy{index="0"} 1
+  workers_busy{index="1"} 0
+
+Samples of a metric are always written as one group: the model is walked
+per metric (at compile time), and per metric over all elements (at run time).
+The exposition is assembled in the context and written in one piece.
+Strings are not samples and are skipped.
+*/
+
+// Emit Co-State (no indentation state; doc holds the exposition, buf the labels)
+
+using context = ctom::context<size_t>;
+
+struct ostream_prom: ctom::ostream_base{
+    typedef prom::context context;
+    context* ctx = NULL;
+    format fmt = COMPACT;
+    ostream_prom operator()(context& c) const { return {{}, &c, COMPACT}; }
+} inline emit;
+
+using ostream = ctom::ostream<ostream_prom>;
+
+inline ostream operator<<(std::ostream& os, ostream_prom const& m) {
+    return ostream(os, (m.ctx != NULL) ? *m.ctx : ctom::local<context>(), m.fmt);
+}
+
+// Compile-Time Names
+//  Characters outside [a-zA-Z0-9_:] and a leading digit are replaced by '_'.
+
+constexpr bool name_char(char c, bool first){
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':'
+        || (!first && c >= '0' && c <= '9');
+}
+
+template<constexpr_string A, constexpr_string B>
+constexpr auto join(){
+    constexpr size_t N = (A.size() > 0 ? A.size() + 1 : 0) + B.size();
+    char v[N + 1] = {};
+    size_t n = 0;
+    for(char c: A) v[n++] = c;
+    if(A.size() > 0) v[n++] = '_';
+    for(char c: B) v[n++] = c;
+    for(size_t i = 0; i < N; i++)
+        if(!name_char(v[i], i == 0)) v[i] = '_';
+    return constexpr_string<N>(v);
+}
+
+// Label Name at Nesting Depth D: base, base_1, base_2, ...
+
+template<constexpr_string B, size_t D>
+constexpr auto label(){
+    constexpr size_t digits = [](){
+        size_t n = 1;
+        for(size_t d = D; d >= 10; d /= 10) n++;
+        return n;
+    }();
+    constexpr size_t N = B.size() + ((D > 0) ? digits + 1 : 0);
+    char v[N + 1] = {};
+    size_t n = 0;
+    for(char c: B) v[n++] = c;
+    if(D > 0){
+        v[n++] = '_';
+        for(size_t d = D, i = N; i > n; d /= 10)
+            v[--i] = '0' + d % 10;
+    }
+    return constexpr_string<N>(v);
+}
+
+// Sample Values: numbers, bools, enums and atomics of these
+
+template<typename V>
+constexpr bool is_sample(){
+    if constexpr(requires(V& v){ v.load(); })
+        return is_sample<decltype(std::declval<V&>().load())>();
+    else return (std::is_arithmetic_v<V> && !std::is_same_v<V, char>) || std::is_enum_v<V>;
+}
+
+template<typename V>
+void put_sample(std::string& out, V& v){
+    if constexpr(requires(V& v){ v.load(); }){
+        auto x = v.load(std::memory_order_relaxed);
+        put_sample(out, x);
+    }
+    else if constexpr(std::is_enum_v<V>){
+        auto x = (std::underlying_type_t<V>)v;
+        put_sample(out, x);
+    }
+    else if constexpr(std::is_same_v<V, bool>)
+        out += v ? '1' : '0';
+    else {
+        if constexpr(std::is_floating_point_v<V>)
+        if(!std::isfinite(v)){
+            out += std::isnan(v) ? "NaN" : (v > 0 ? "+Inf" : "-Inf");
+            return;
+        }
+        char buf[64];
+        auto res = std::to_chars(buf, buf + sizeof(buf), v);
+        out.append(buf, res.ptr - buf);
+    }
+}
+
+// Label Values are Escaped: backslash, double-quote and line feed
+
+inline void put_label(std::string& out, std::string_view name, std::string_view val){
+    if(!out.empty()) out += ',';
+    out += name;
+    out += "=\"";
+    for(char c: val){
+        if(c == '\\') out += "\\\\";
+        else if(c == '"') out += "\\\"";
+        else if(c == '\n') out += "\\n";
+        else out += c;
+    }
+    out += '"';
+}
+
+/*
+================================================================================
+                            Per-Metric Run-Time Path
+================================================================================
+A path is the sequence of steps from the root to one metric's values.
+Keys are followed directly, elements are iterated with their label pushed.
+*/
+
+template<constexpr_string K> struct step_key{};     // member K of an object
+template<constexpr_string L> struct step_each{};    // every element, labelled L
+template<size_t I> struct step_alt{};               // alternative I, if active
+
+template<constexpr_string Name, typename... Steps>
+struct path;
+
+template<constexpr_string Name>
+struct path<Name> {
+    template<val_t T>
+    static void emit(context& ctx, T& node){
+        auto& out = ctx.doc;
+        out.append(Name.value, Name.size());
+        if(!ctx.buf.empty()){
+            out += '{';
+            out += ctx.buf;
+            out += '}';
+        }
+        out += ' ';
+        put_sample(out, *node.value);
+        out += '\n';
+    }
+};
+
+template<constexpr_string Name, constexpr_string K, typename... Steps>
+struct path<Name, step_key<K>, Steps...> {
+    template<obj_t T>
+    static void emit(context& ctx, T& node){
+        auto& ref = node.template get<key_impl<K>>();
+        if(ref.node.impl != NULL)
+            path<Name, Steps...>::emit(ctx, *ref.node.impl);
+    }
+};
+
+template<constexpr_string Name, constexpr_string L, typename... Steps>
+struct path<Name, step_each<L>, Steps...> {
+
+    template<typename T>
+    static void each(context& ctx, T& node, std::string_view label){
+        size_t base = ctx.buf.size();
+        put_label(ctx.buf, std::string_view(L.value, L.size()), label);
+        path<Name, Steps...>::emit(ctx, node);
+        ctx.buf.resize(base);
+    }
+
+    template<impl_t T>
+    static void emit(context& ctx, T& node){
+        char buf[24];
+        auto index = [&buf](size_t n){
+            auto res = std::to_chars(buf, buf + sizeof(buf), n);
+            return std::string_view(buf, res.ptr - buf);
+        };
+        if constexpr(arr_t<T>){
+            size_t n = 0;
+            node.for_refs([&](auto&& ref){
+                auto label = index(n++);
+                if(ref.node.impl != NULL)
+                    each(ctx, *ref.node.impl, label);
+            });
+        }
+        else if constexpr(seq_t<T>){
+            for(size_t n = 0; n < node.size(); n++)
+                each(ctx, node.at(n), index(n));
+        }
+        else if constexpr(map_t<T>){
+            node.for_entries(ctx.order, [&](auto& entry){
+                bind<typename T::mapped_type> ref(entry.second);
+                each(ctx, ref.impl, entry.first);
+            });
+        }
+    }
+
+};
+
+template<constexpr_string Name, size_t I, typename... Steps>
+struct path<Name, step_alt<I>, Steps...> {
+    template<var_t T>
+    static void emit(context& ctx, T& node){
+        if(node.value->index() != I)
+            return;
+        auto& alt = std::get<I>(*node.value);
+        bind<std::decay_t<decltype(alt)>> ref(alt);
+        path<Name, Steps...>::emit(ctx, ref.impl);
+    }
+};
+
+/*
+================================================================================
+                          Compile-Time Metric Walk
+================================================================================
+Visits every sample value type below T, building its name and path,
+DI / DK count the index and key labels above it.
+*/
+
+template<typename T, constexpr_string Name, size_t DI, size_t DK, typename... Steps>
+struct walk {
+
+    template<typename R>
+    static void emit(context& ctx, R& root){
+
+        if constexpr(val_t<T>){
+            using V = std::remove_reference_t<decltype(*std::declval<T&>().value)>;
+            if constexpr(is_sample<V>()){
+                static_assert(Name.size() > 0, "a sample without a metric name (the root must be an object)");
+                path<Name, Steps...>::emit(ctx, root);
+            }
+        }
+
+        else if constexpr(obj_t<T>){
+            T::for_type::iter([&]<typename Ref>(){
+                using N = std::remove_pointer_t<decltype(std::declval<Ref&>().node.impl)>;
+                walk<N, join<Name, Ref::key>(), DI, DK, Steps..., step_key<Ref::key>>::emit(ctx, root);
+            });
+        }
+
+        else if constexpr(arr_t<T>){
+            using Ref = std::tuple_element_t<0, decltype(std::declval<T&>().nodes)>;
+            using N = std::remove_pointer_t<decltype(std::declval<Ref&>().node.impl)>;
+            walk<N, Name, DI + 1, DK, Steps..., step_each<label<"index", DI>()>>::emit(ctx, root);
+        }
+
+        else if constexpr(seq_t<T>){
+            walk<typename T::elem_type, Name, DI + 1, DK, Steps..., step_each<label<"index", DI>()>>::emit(ctx, root);
+        }
+
+        else if constexpr(map_t<T>){
+            using N = typename rule<typename T::mapped_type>::type;
+            walk<N, Name, DI, DK + 1, Steps..., step_each<label<"key", DK>()>>::emit(ctx, root);
+        }
+
+        else if constexpr(var_t<T>){
+            using V = typename T::value_type;
+            [&]<size_t... I>(std::index_sequence<I...>){
+                (walk<typename rule<std::variant_alternative_t<I, V>>::type, Name, DI, DK, Steps..., step_alt<I>>::emit(ctx, root), ...);
+            }(std::make_index_sequence<std::variant_size_v<V>>());
+        }
+
+    }
+
+};
+
+template<typename T>
+ostream operator<<(ostream const& os, T& type){
+    bind<T> ref(type);
+    using R = std::remove_reference_t<decltype(ref.impl)>;
+    os.ctx.doc.clear();
+    os.ctx.buf.clear();
+    walk<R, "", 0, 0>::emit(os.ctx, ref.impl);
+    os.os.write(os.ctx.doc.data(), os.ctx.doc.size());
+    return os;
+}
+
+}   // end of namespace prom
+}   // end of namespace ctom
+
+#endif
@@ -0,0 +1,235 @@
+#ifndef CTOM_RELOAD
+#define CTOM_RELOAD
+
+#include "ctom.hpp"
+#include "yaml.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace ctom {
+
+/*
+================================================================================
+                            Hot-Reloaded Models
+================================================================================
+A reloader owns the current snapshot of a model loaded from a file. It watches
+the file with inotify and, on every change, parses a fresh shadow instance on
+its own thread, validates it and publishes it with an atomic pointer swap:
+
+  ctom::reloader<config> cfg("service.yaml", [](config const& c){
+    if(c.port == 0) throw std::invalid_argument("port must be set");
+  });
+
+  auto c = cfg.read();          // pinned snapshot, never blocks
+  serve(c->host, c->port);
+
+Readers only pin a snapshot (two atomic increments and a load), so they never
+wait for a reload and never see a partially parsed model. A replaced snapshot
+is deleted once no reader pins it anymore (two-phase grace period, waited for
+on the reload thread). A file which fails to parse or validate is ignored,
+the current snapshot stays, and error() holds the reason.
+
+The directory of the file is watched, so that files replaced by a rename (as
+editors and deployment tools do) are picked up.
+*/
+
+template<typename T>
+struct reloader {
+
+    using validator = std::function<void(T const&)>;
+    using parser = std::function<void(std::istream&, T&)>;
+
+    // Pinned Snapshot: valid while the handle lives
+
+    struct snapshot {
+
+        T const* ptr;
+        std::atomic<size_t>* pin;
+
+        snapshot(T const* ptr, std::atomic<size_t>* pin):ptr(ptr),pin(pin){}
+        snapshot(snapshot&& other):ptr(other.ptr),pin(other.pin){ other.pin = NULL; }
+        snapshot(snapshot const&) = delete;
+
+        ~snapshot(){
+            if(pin != NULL)
+                pin->fetch_sub(1, std::memory_order_release);
+        }
+
+        T const& operator*() const { return *ptr; }
+        T const* operator->() const { return ptr; }
+
+    };
+
+    std::string dir, name;
+    validator validate;
+    parser parse;
+
+    std::atomic<T*> current;
+    std::atomic<size_t> epoch = 0;      // selects the reader counter to pin
+    mutable std::atomic<size_t> readers[2];
+    std::atomic<size_t> loaded = 0;     // snapshots published
+
+    std::mutex lock;                    // serializes reloads and error
+    std::string failure;
+
+    int notify = -1;
+    int wake = -1;
+    std::thread watcher;
+
+    reloader(std::string path, validator validate = {}, parser parse = [](std::istream& is, T& t){ is >> yaml::parse >> t; })
+    :validate(validate),parse(parse),current(NULL){
+
+        readers[0] = 0;
+        readers[1] = 0;
+
+        auto slash = path.rfind('/');
+        dir = (slash == std::string::npos) ? "." : path.substr(0, (slash == 0) ? 1 : slash);
+        name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+
+        // Initial load: a file which does not load is an error
+
+        if(!reload())
+            throw parse_exception(path + ": " + error());
+
+        notify = ::inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+        wake = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if(notify < 0 || wake < 0 || ::inotify_add_watch(notify, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0){
+            int e = errno;
+            close();
+            throw std::system_error(e, std::generic_category(), "ctom::reloader: " + dir);
+        }
+
+        watcher = std::thread([this]{ watch(); });
+
+    }
+
+    ~reloader(){
+        if(watcher.joinable()){
+            uint64_t one = 1;
+            while(::write(wake, &one, sizeof(one)) < 0 && errno == EINTR);
+            watcher.join();
+        }
+        close();
+        delete current.load();
+    }
+
+    reloader(reloader const&) = delete;
+    reloader& operator=(reloader const&) = delete;
+
+    // Readers
+
+    snapshot read() const {
+        auto& pin = readers[epoch.load() & 1];
+        pin.fetch_add(1);
+        return snapshot(current.load(), &pin);
+    }
+
+    size_t version() const {
+        return loaded.load();
+    }
+
+    std::string error(){
+        std::lock_guard<std::mutex> guard(lock);
+        return failure;
+    }
+
+    // Parse, validate and publish the file; false (and error) if it was rejected
+
+    bool reload(){
+
+        std::lock_guard<std::mutex> guard(lock);
+
+        T* shadow = new T();
+        try {
+            std::ifstream in(dir + "/" + name);
+            if(!in)
+                throw parse_exception("failed to open file");
+            parse(in, *shadow);
+            if(validate)
+                validate(*shadow);
+        } catch(std::exception const& e){
+            delete shadow;
+            failure = e.what();
+            return false;
+        }
+
+        failure.clear();
+        T* old = current.exchange(shadow);
+        loaded.fetch_add(1);
+
+        if(old != NULL){
+            synchronize();
+            delete old;
+        }
+        return true;
+
+    }
+
+    // Grace Period: every reader which may still pin the old snapshot is done.
+    //  A reader may pin the counter of the previous epoch late, so both are waited for.
+
+    void synchronize(){
+        for(int n = 0; n < 2; n++){
+            size_t e = epoch.fetch_add(1);
+            while(readers[e & 1].load() != 0)
+                std::this_thread::yield();
+        }
+    }
+
+    // Watcher Thread: reload once per burst of events on the file
+
+    void watch(){
+
+        alignas(inotify_event) char buf[4096];
+        pollfd fds[2] = {{notify, POLLIN, 0}, {wake, POLLIN, 0}};
+
+        while(true){
+
+            if(::poll(fds, 2, -1) < 0){
+                if(errno == EINTR) continue;
+                return;
+            }
+            if(fds[1].revents != 0)
+                return;
+
+            bool changed = false;
+            ssize_t n;
+            while((n = ::read(notify, buf, sizeof(buf))) > 0)
+            for(char* p = buf; p < buf + n; ){
+                auto* ev = reinterpret_cast<inotify_event*>(p);
+                if(ev->len > 0 && name == ev->name)
+                    changed = true;
+                p += sizeof(inotify_event) + ev->len;
+            }
+
+            if(changed)
+                reload();
+
+        }
+
+    }
+
+    void close(){
+        if(notify >= 0) ::close(notify);
+        if(wake >= 0) ::close(wake);
+        notify = wake = -1;
+    }
+
+};
+
+}   // end of namespace ctom
+
+#endif
@@ -0,0 +1,267 @@
+#ifndef CTOM_SCALAR
+#define CTOM_SCALAR
+
+#include "ctom.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace ctom {
+namespace scalar {
+
+/*
+================================================================================
+                            SWAR Digit Conversion
+================================================================================
+Eight ASCII digits are validated and converted with a handful of 64-bit
+operations instead of eight dependent multiply-adds.
+*/
+
+constexpr bool swar = (std::endian::native == std::endian::little);
+
+inline uint64_t load8(const char* p){
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline bool is_eight_digits(uint64_t v){
+    return ((v & 0xF0F0F0F0F0F0F0F0ull) == 0x3030303030303030ull)
+        && (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) == 0x3030303030303030ull);
+}
+
+inline uint32_t parse_eight_digits(uint64_t v){
+    v -= 0x3030303030303030ull;
+    v = (v * 10) + (v >> 8);
+    v = (((v & 0x000000FF000000FFull) * 0x000F424000000064ull)
+      + (((v >> 16) & 0x000000FF000000FFull) * 0x0000271000000001ull)) >> 32;
+    return (uint32_t)v;
+}
+
+inline bool is_digit(char c){
+    return c >= '0' && c <= '9';
+}
+
+// Accumulate decimal digits into v, counting them in n; returns their end.
+//  19 digits always fit, beyond that every step is overflow-checked.
+
+inline const char* get_digits(const char* p, const char* end, uint64_t& v, size_t& n, bool& overflow){
+
+    if constexpr(swar)
+    while(end - p >= 8 && n + 8 <= 19 && is_eight_digits(load8(p))){
+        v = v * 100000000 + parse_eight_digits(load8(p));
+        p += 8;
+        n += 8;
+    }
+
+    for(; p < end && is_digit(*p); p++, n++){
+        if(n < 19)
+            v = 10 * v + (*p - '0');
+        else if(__builtin_mul_overflow(v, 10, &v) || __builtin_add_overflow(v, (uint64_t)(*p - '0'), &v))
+            overflow = true;
+    }
+
+    return p;
+
+}
+
+/*
+================================================================================
+                               Scalar Parsers
+================================================================================
+Every parser consumes the full view, range errors and trailing characters
+throw a parse_exception.
+*/
+
+inline void parse_bool(bool& t, std::string_view v){
+    if(v == "true" || v == "True" || v == "TRUE") t = true;
+    else if(v == "false" || v == "False" || v == "FALSE") t = false;
+    else throw parse_exception("invalid bool");
+}
+
+template<std::integral T>
+void parse_int(T& t, std::string_view v){
+
+    auto p = v.data();
+    auto end = p + v.size();
+
+    bool neg = false;
+    if(p < end && (*p == '-' || *p == '+')){
+        neg = (*p == '-');
+        p++;
+    }
+
+    if(p == end || !is_digit(*p))
+        throw parse_exception("invalid argument");
+
+    uint64_t mag = 0;
+    size_t digits = 0;
+    bool overflow = false;
+    p = get_digits(p, end, mag, digits, overflow);
+
+    if(p != end)
+        throw parse_exception("invalid trailing characters");
+
+    constexpr uint64_t max = std::numeric_limits<T>::max();
+    if constexpr(std::is_signed_v<T>){
+        if(overflow || mag > max + (uint64_t)neg)
+            throw parse_exception("out of range");
+        t = neg ? (T)(0 - mag) : (T)mag;
+    } else {
+        if(overflow || mag > max || (neg && mag != 0))
+            throw parse_exception("out of range");
+        t = (T)mag;
+    }
+
+}
+
+// Exact Powers of Ten (Fast Path Operands)
+
+template<std::floating_point T>
+struct exact {
+    static constexpr int max_exp = std::is_same_v<T, float> ? 10 : 22;
+    static constexpr uint64_t max_mant = uint64_t(1) << std::min(std::numeric_limits<T>::digits, 53);
+    static constexpr T pow10[23] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+};
+
+// Fast Path: mantissa and power of ten are both exact, so a single
+//  correctly rounded multiply / divide gives the correctly rounded result.
+//  Everything else (long mantissas, large exponents, inf / nan) falls back
+//  to from_chars, which is exact for all inputs.
+
+template<std::floating_point T>
+void parse_float(T& t, std::string_view v){
+
+    auto p = v.data();
+    auto end = p + v.size();
+
+    bool neg = false;
+    if(p < end && (*p == '-' || *p == '+')){
+        neg = (*p == '-');
+        p++;
+    }
+
+    uint64_t mant = 0;
+    size_t digits = 0;
+    bool overflow = false;
+    p = get_digits(p, end, mant, digits, overflow);
+
+    int64_t exp = 0;
+    if(p < end && *p == '.'){
+        auto frac = ++p;
+        p = get_digits(p, end, mant, digits, overflow);
+        exp -= p - frac;
+    }
+
+    if(digits > 0 && p < end && (*p == 'e' || *p == 'E')){
+        p++;
+        bool eneg = false;
+        if(p < end && (*p == '-' || *p == '+')){
+            eneg = (*p == '-');
+            p++;
+        }
+        if(p == end || !is_digit(*p))
+            throw parse_exception("invalid exponent");
+        int64_t e = 0;
+        for(; p < end && is_digit(*p); p++)
+            if(e < 100000) e = 10 * e + (*p - '0');
+        exp += eneg ? -e : e;
+    }
+
+    constexpr bool fast = std::is_same_v<T, float> || std::is_same_v<T, double>;
+    if(fast && digits > 0 && p == end && digits <= 19 && !overflow
+    && mant <= exact<T>::max_mant && exp >= -exact<T>::max_exp && exp <= exact<T>::max_exp){
+        T r = (T)mant;
+        if(exp < 0) r /= exact<T>::pow10[-exp];
+        else r *= exact<T>::pow10[exp];
+        t = neg ? -r : r;
+        return;
+    }
+
+    // Fallback (from_chars rejects a leading '+')
+
+    if(!v.empty() && v.front() == '+')
+        v.remove_prefix(1);
+
+    auto res = std::from_chars(v.data(), v.data() + v.size(), t);
+    if(res.ec == std::errc::invalid_argument)
+        throw parse_exception("invalid argument");
+    if(res.ec == std::errc::result_out_of_range)
+        throw parse_exception("out of range");
+    if(res.ptr != v.data() + v.size())
+        throw parse_exception("invalid trailing characters");
+
+}
+
+}   // end of namespace scalar
+
+/*
+================================================================================
+                                Value-Parser
+================================================================================
+Shared by all backends: the view holds the unquoted, unescaped value.
+*/
+
+template<typename T>
+void parse_val(T& t, std::string_view v){
+    if constexpr(std::is_same_v<T, bool>)
+        scalar::parse_bool(t, v);
+    else if constexpr(std::is_integral_v<T>)
+        scalar::parse_int(t, v);
+    else if constexpr(std::is_floating_point_v<T>)
+        scalar::parse_float(t, v);
+    else {
+        auto res = std::from_chars(v.data(), v.data() + v.size(), t);
+        if(res.ec == std::errc::invalid_argument)
+            throw parse_exception("invalid argument");
+        if(res.ec == std::errc::result_out_of_range)
+            throw parse_exception("out of range");
+        if(res.ptr != v.data() + v.size())
+            throw parse_exception("invalid trailing characters");
+    }
+}
+
+template<>
+inline void parse_val<char>(char& t, std::string_view v){
+    if(v.size() != 1)
+        throw parse_exception("invalid size for char");
+    t = v[0];
+}
+
+template<>
+inline void parse_val<std::string>(std::string& t, std::string_view v){
+    t = v;
+}
+
+// Value-Node Parser
+//  Enums by name, string views into the intern pool or the document,
+//  all other values by value.
+
+template<val_t T, typename S>
+void parse_node(T& node, std::string_view v, context<S>& ctx){
+    using V = std::remove_reference_t<decltype(*node.value)>;
+    if constexpr(enum_t<T>)
+        node.parse(v);
+    else if constexpr(std::is_same_v<V, std::string_view>){
+        if(ctx.intern != NULL)
+            *node.value = ctx.intern->intern(v);
+        else if(ctx.target != NULL)
+            *node.value = ctx.target->keep(v);
+        else throw parse_exception("string_view values require a ctom::document or an intern pool");
+    }
+    else parse_val(*node.value, v);
+}
+
+}   // end of namespace ctom
+
+#endif
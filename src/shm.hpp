@@ -0,0 +1,251 @@
+#ifndef CTOM_SHM
+#define CTOM_SHM
+
+#include "ctom.hpp"
+#include "binary.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ctom {
+namespace shm {
+
+/*
+================================================================================
+                        Shared-Memory Publication
+================================================================================
+A publisher writes a model in the fixed binary layout (see ctom::binary) into
+a POSIX shared-memory segment, readers in any process on the host map the
+segment and read consistent snapshots without locks and without parsing:
+
+  ctom::shm::publisher pub("/service-config", 1 << 16);
+  pub.publish(config);                  // on every change
+
+  ctom::shm::reader sub("/service-config");
+  if(sub.update(config))                // new version since the last update
+    ...
+
+The segment is guarded by a sequence lock: the publisher makes the sequence
+odd while writing and even again afterwards. Readers copy the record out and
+retry if the sequence was odd or changed meanwhile, so they never block the
+publisher. There is one publisher per segment.
+*/
+
+// Segment Header, followed by the record
+
+struct header {
+    static constexpr uint64_t tag = 0x31304d4f5443;    // "CTOM01"
+    uint64_t magic;
+    uint64_t capacity;                  // record bytes following the header
+    std::atomic<uint64_t> seq;          // odd while a record is written
+    std::atomic<uint64_t> size;         // bytes of the current record
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "sequence lock requires lock-free 64-bit atomics");
+
+// Mapped Segment
+
+struct segment {
+
+    void* data = MAP_FAILED;
+    size_t bytes = 0;
+
+    segment(const char* name, int flags, size_t capacity){
+
+        int fd = ::shm_open(name, flags, 0644);
+        if(fd < 0)
+            throw std::system_error(errno, std::generic_category(), std::string("ctom::shm: ") + name);
+
+        if(flags & O_CREAT){
+            bytes = sizeof(header) + capacity;
+            if(::ftruncate(fd, bytes) < 0){
+                int e = errno;
+                ::close(fd);
+                throw std::system_error(e, std::generic_category(), std::string("ctom::shm: ") + name);
+            }
+        } else {
+            struct stat st;
+            if(::fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(header)){
+                int e = errno;
+                ::close(fd);
+                throw std::system_error(e ? e : EINVAL, std::generic_category(), std::string("ctom::shm: ") + name);
+            }
+            bytes = st.st_size;
+        }
+
+        int prot = ((flags & O_ACCMODE) == O_RDONLY) ? PROT_READ : PROT_READ | PROT_WRITE;
+        data = ::mmap(NULL, bytes, prot, MAP_SHARED, fd, 0);
+        int e = errno;
+        ::close(fd);
+        if(data == MAP_FAILED)
+            throw std::system_error(e, std::generic_category(), std::string("ctom::shm: ") + name);
+
+    }
+
+    ~segment(){
+        if(data != MAP_FAILED)
+            ::munmap(data, bytes);
+    }
+
+    segment(segment const&) = delete;
+    segment& operator=(segment const&) = delete;
+
+    header* head() const {
+        return static_cast<header*>(data);
+    }
+
+    char* record() const {
+        return static_cast<char*>(data) + sizeof(header);
+    }
+
+};
+
+/*
+================================================================================
+                                Publisher
+================================================================================
+*/
+
+struct publisher {
+
+    std::string name;
+    segment seg;
+    std::string buf;            // encoded record
+
+    publisher(const char* name, size_t capacity)
+    :name(name),seg(name, O_CREAT | O_RDWR, capacity){
+        auto* h = seg.head();
+        h->capacity = capacity;
+        h->size.store(0, std::memory_order_relaxed);
+        h->seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        h->magic = header::tag;
+    }
+
+    // Remove the name; mapped readers keep the last record
+
+    void unlink(){
+        ::shm_unlink(name.c_str());
+    }
+
+    template<typename T>
+    void publish(T& type){
+
+        binary::encode(buf, type);
+
+        auto* h = seg.head();
+        if(buf.size() > h->capacity)
+            throw parse_exception("record of " + std::to_string(buf.size()) + " bytes exceeds the segment capacity");
+
+        uint64_t s = h->seq.load(std::memory_order_relaxed);
+        h->seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memcpy(seg.record(), buf.data(), buf.size());
+        h->size.store(buf.size(), std::memory_order_relaxed);
+
+        h->seq.store(s + 2, std::memory_order_release);
+
+    }
+
+    uint64_t version() const {
+        return seg.head()->seq.load(std::memory_order_relaxed) / 2;
+    }
+
+};
+
+/*
+================================================================================
+                                  Reader
+================================================================================
+*/
+
+struct reader {
+
+    segment seg;
+    std::string buf;            // consistent copy of the record
+    uint64_t seen = 0;          // sequence of the last decoded record
+
+    reader(const char* name):seg(name, O_RDONLY, 0){
+        if(seg.head()->magic != header::tag || seg.bytes < sizeof(header) + seg.head()->capacity)
+            throw parse_exception(std::string("not a ctom::shm segment: ") + name);
+    }
+
+    // Copy of the current record, false if none was published yet.
+    //  A publisher which died mid-write leaves the sequence odd: the reader
+    //  yields while it retries, and gives up after a bounded number of tries.
+
+    static constexpr size_t retries = 1 << 16;
+
+    bool snapshot(){
+        auto* h = seg.head();
+        size_t mapped = seg.bytes - sizeof(header);
+        for(size_t k = 0; k < retries; k++){
+
+            if(k > 0)
+                std::this_thread::yield();
+
+            uint64_t s0 = h->seq.load(std::memory_order_acquire);
+            if(s0 & 1)
+                continue;
+            if(s0 == 0)
+                return false;
+
+            size_t n = h->size.load(std::memory_order_relaxed);
+            if(n <= mapped){
+                buf.resize(n);
+                std::memcpy(buf.data(), seg.record(), n);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t s1 = h->seq.load(std::memory_order_relaxed);
+            if(s0 != s1)
+                continue;
+            if(n > mapped)
+                throw parse_exception("shm record larger than the mapped segment");
+            seen = s0;
+            return true;
+
+        }
+        throw parse_exception("shm record is not consistent: publisher did not finish");
+    }
+
+    // Decode the current record into type
+
+    template<typename T>
+    bool read(T& type){
+        if(!snapshot())
+            return false;
+        binary::decode(buf, type);
+        return true;
+    }
+
+    // Decode only if a new record was published since the last read
+
+    template<typename T>
+    bool update(T& type){
+        if(seg.head()->seq.load(std::memory_order_acquire) == seen)
+            return false;
+        return read(type);
+    }
+
+    uint64_t version() const {
+        return seen / 2;
+    }
+
+};
+
+}   // end of namespace shm
+}   // end of namespace ctom
+
+#endif
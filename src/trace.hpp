@@ -0,0 +1,87 @@
+#ifndef CTOM_TRACE
+#define CTOM_TRACE
+
+/*
+================================================================================
+                        Static Tracepoints (USDT)
+================================================================================
+Compiled with -DCTOM_USDT and <sys/sdt.h> available (systemtap-sdt-dev),
+the yaml and json backends contain USDT probes of provider "ctom", which
+perf and bpftrace attach to in a running binary without rebuilding it:
+
+  parse_begin   (format, bytes)
+  parse_end     (format, bytes, lines)
+  parse_error   (format, offset, line, message)
+  object_enter  (format, key, offset)
+  object_leave  (format, key, offset)
+  emit_begin    (format)
+  emit_end      (format)
+
+format is "yaml" or "json", key the member key ("" at the root and for
+array / sequence elements), offset the byte offset into the parsed text.
+Object probes fire while parsing, for object and tagged-union nodes; objects
+nested inside a flow collection are attributed to the collection's key.
+
+A disabled probe is a single nop. Without CTOM_USDT (or without the header)
+the probes expand to nothing and their arguments are not evaluated.
+See examples/17_trace/ctom.bt for a bpftrace script.
+*/
+
+#if defined(CTOM_USDT) && __has_include(<sys/sdt.h>)
+
+#include <sys/sdt.h>
+
+#define CTOM_TRACE1(name, a) STAP_PROBE1(ctom, name, a)
+#define CTOM_TRACE2(name, a, b) STAP_PROBE2(ctom, name, a, b)
+#define CTOM_TRACE3(name, a, b, c) STAP_PROBE3(ctom, name, a, b, c)
+#define CTOM_TRACE4(name, a, b, c, d) STAP_PROBE4(ctom, name, a, b, c, d)
+
+#define CTOM_TRACE_OBJECT(format, key, ctx) \
+  ctom::trace::object<std::remove_cvref_t<decltype(ctx)>> ctom_trace_object(format, key, ctx)
+
+#else
+
+#define CTOM_TRACE1(name, a)
+#define CTOM_TRACE2(name, a, b)
+#define CTOM_TRACE3(name, a, b, c)
+#define CTOM_TRACE4(name, a, b, c, d)
+#define CTOM_TRACE_OBJECT(format, key, ctx)
+
+#endif
+
+#include <cstddef>
+#include <type_traits>
+
+namespace ctom {
+namespace trace {
+
+// Byte Offset of the Parse Position
+
+template<typename C>
+size_t offset(C const& ctx){
+  return (size_t)(ctx.src.data() - ctx.text.data());
+}
+
+// Object Scope: leave also fires when an error unwinds the object
+
+template<typename C>
+struct object {
+
+  const char* format;
+  const char* key;
+  C const& ctx;
+
+  object(const char* format, const char* key, C const& ctx):format(format),key((key != NULL) ? key : ""),ctx(ctx){
+    CTOM_TRACE3(object_enter, format, this->key, offset(ctx));
+  }
+
+  ~object(){
+    CTOM_TRACE3(object_leave, format, key, offset(ctx));
+  }
+
+};
+
+}   // end of namespace trace
+}   // end of namespace ctom
+
+#endif
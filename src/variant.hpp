@@ -0,0 +1,93 @@
+#ifndef CTOM_VARIANT
+#define CTOM_VARIANT
+
+#include "ctom.hpp"
+#include "enum.hpp"
+
+#include <array>
+#include <utility>
+#include <string_view>
+#include <variant>
+
+namespace ctom {
+
+/*
+================================================================================
+                              Tagged-Union Nodes
+================================================================================
+A tagged node binds a std::variant whose alternatives are objects. It is
+written as the object of the active alternative, with a tag key in front
+naming the alternative:
+
+  template<> struct ctom::rule<event> {
+    typedef ctom::tagged<event, "type",
+      ctom::alt<"login", login>,
+      ctom::alt<"logout", logout>
+    > type;
+  };
+
+  type: login
+  user: someone
+
+Parsers read the tag first (scanning ahead without converting values) and
+dispatch through a table indexed by the alternative, so no alternative is
+ever parsed on trial.
+*/
+
+template<constexpr_string N, typename T>
+struct alt {
+  static constexpr auto name = N;
+  typedef T type;
+};
+
+template<typename V, constexpr_string Tag, typename... Alts>
+struct tagged: var_base {
+
+  static_assert(std::is_same_v<V, std::variant<typename Alts::type...>>, "tagged alternatives do not match the variant");
+  static_assert((obj_t<typename rule<typename Alts::type>::type> && ...), "tagged alternatives must be objects");
+
+  using value_type = V;
+  static constexpr size_t N = sizeof...(Alts);
+  static constexpr std::string_view tag = std::string_view(Tag.value, Tag.size());
+
+  static constexpr name_table<N> table{{ std::string_view(Alts::name.value, Alts::name.size())... }};
+  static_assert(table.valid(), "tagged names have no perfect hash (duplicate names?)");
+
+  V* value = NULL;
+
+  tagged(V& v) noexcept {
+    value = &v;
+  }
+
+  void operator=(V& v){
+    if(value != NULL)
+    *value = v;
+  }
+
+  static std::string_view name(size_t index){
+    return table.names[index];
+  }
+
+  // Active alternative I, switching to it if another one is held
+
+  template<size_t I>
+  auto& get(){
+    if(value->index() != I)
+      value->template emplace<I>();
+    return std::get<I>(*value);
+  }
+
+  // Compile-Time Dispatch Table: one entry per alternative
+
+  template<typename F>
+  static constexpr auto dispatch(){
+    return []<size_t... I>(std::index_sequence<I...>){
+      return std::array{ &F::template call<I>... };
+    }(std::make_index_sequence<N>());
+  }
+
+};
+
+}   // end of namespace ctom
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef CTOM_VIEW
+#define CTOM_VIEW
+
+#include "ctom.hpp"
+#include "binary.hpp"
+
+#include <algorithm>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace ctom {
+
+/*
+================================================================================
+                            Zero-Copy Record Views
+================================================================================
+A view reads the fields of a record in the fixed binary layout (see
+ctom::binary) directly from its bytes, without decoding the record:
+
+  ctom::view<config> v(bytes);
+  int port = v.get<"port">();                   // numbers, bools, enums
+  std::string_view host = v.get<"host">();      // strings, into the bytes
+  auto limit = v.get<"limit">();                // objects, arrays: views
+  auto ports = v.get<"ports">();                // sequences: views
+  for(size_t n = 0; n < ports.size(); n++)
+    ports[n];
+
+Offsets are resolved at compile time. Values are read with their byte order
+converted and at any alignment, so the bytes can be e.g. an mmap'd file:
+
+  for(auto v: ctom::records<config>(file))
+    ...
+
+Spans which point past the bytes throw a parse_exception.
+*/
+
+template<typename M>
+struct view;
+
+namespace binary {
+
+// Value, or nested view, of node N at offset at
+
+template<typename N>
+auto read(std::string_view data, size_t at){
+  if constexpr(val_t<N>){
+    using V = value_of<N>;
+    if constexpr(scalar_t<V>)
+      return load<V>(data.data() + at);
+    else {
+      auto s = load_span(data.data() + at);
+      return sub(data, s.offset, s.size);
+    }
+  }
+  else return view<N>(data, at);
+}
+
+}   // end of namespace binary
+
+template<typename M>
+struct view {
+
+  using type = typename rule<M>::type;
+  using layout = binary::layout<type>;
+
+  std::string_view data;    // the record
+  size_t at;                // offset of this node in the record
+
+  view(std::string_view data, size_t at = 0):data(data),at(at){
+    binary::sub(data, at, layout::size);
+  }
+
+  // Object Members by Key
+
+  template<constexpr_string K>
+  auto get() const {
+    static_assert(obj_t<type>, "only objects are indexed by key");
+    using Ref = std::remove_reference_t<decltype(std::declval<type&>().template get<key_impl<K>>())>;
+    constexpr size_t I = type::template index<key_impl<K>>::value;
+    return binary::read<binary::node_of<Ref>>(data, at + layout::offsets[I]);
+  }
+
+  // Array Elements by Index
+
+  template<size_t I>
+  auto get() const {
+    static_assert(arr_t<type>, "only arrays are indexed by position");
+    using Ref = std::remove_reference_t<decltype(std::declval<type&>().template get<ind_impl<I>>())>;
+    return binary::read<binary::node_of<Ref>>(data, at + layout::offsets[type::template index<ind_impl<I>>::value]);
+  }
+
+  // Sequence Elements
+
+  size_t size() const requires seq_t<type> {
+    return binary::load_span(data.data() + at).size;
+  }
+
+  auto operator[](size_t n) const requires seq_t<type> {
+    using L = typename layout::elem;
+    auto s = binary::load_span(data.data() + at);
+    if(n >= s.size)
+      throw parse_exception("sequence index out of range");
+    size_t off = s.offset + n*L::size;
+    binary::sub(data, off, L::size);
+    return binary::read<typename type::elem_type>(data, off);
+  }
+
+};
+
+// Views of the Records of a Record File (see binary::encode_record)
+
+template<typename M>
+struct records {
+
+  std::string_view data;
+
+  records(std::string_view data):data(data){}
+
+  struct iterator {
+
+    std::string_view data;
+    size_t at;
+
+    // Size of the record at at, checked against the file
+
+    size_t size() const {
+      binary::sub(data, at, 8);
+      auto n = binary::load<uint64_t>(data.data() + at);
+      binary::sub(data, at + 8, n);
+      return n;
+    }
+
+    view<M> operator*() const {
+      return view<M>(data.substr(at + 8, size()));
+    }
+
+    iterator& operator++(){
+      at = std::min(data.size(), binary::align_up(at + 8 + size(), binary::alignment));
+      return *this;
+    }
+
+    bool operator!=(iterator const& other) const {
+      return at != other.at;
+    }
+
+  };
+
+  iterator begin() const {
+    return {data, 0};
+  }
+
+  iterator end() const {
+    return {data, data.size()};
+  }
+
+};
+
+}   // end of namespace ctom
+
+#endif
@@ -2,6 +2,11 @@
 #define CTOM_YAML
 
 #include "ctom.hpp"
+#include "escape.hpp"
+#include "scalar.hpp"
+#include "enum.hpp"
+#include "variant.hpp"
+#include "trace.hpp"
 
 #include <string>
 #include <string_view>
@@ -11,20 +16,6 @@
 namespace ctom {
 namespace yaml {
 
-struct ostream_yaml: ctom::ostream_base{} static emit;
-struct istream_yaml: ctom::istream_base{} static parse;
-
-using ostream = ctom::ostream<ostream_yaml>;
-using istream = ctom::istream<istream_yaml>;
-
-ostream operator<<(std::ostream& os, ostream_yaml&) {
-    return ostream(os);
-}
-
-istream operator>>(std::istream& is, istream_yaml&) {
-    return istream(is);
-}
-
 /*
 ================================================================================
                             YAML Model Co-State
@@ -38,47 +29,116 @@ enum indentstate {
     DASH
 };
 
-struct indent {
-    std::vector<indentstate> state;
-    indent(){}
-    indent(std::initializer_list<indentstate> s){
-        state = s;
-    }
+using context = ctom::context<indentstate>;
+using exception = ctom::exception;
+
+// Stream Modifiers
+//  emit(ctx) / parse(ctx) reuse an explicit context, otherwise a thread-local
+//  default context is used. emit(ctom::COMPACT) writes a single flow line.
+//  parse(doc) reads into a document handle, which std::string_view values point into.
+
+struct ostream_yaml: ctom::ostream_base{
+    typedef yaml::context context;
+    context* ctx = NULL;
+    format fmt = PRETTY;
+    ostream_yaml operator()(format f) const { return {{}, NULL, f}; }
+    ostream_yaml operator()(context& c, format f = PRETTY) const { return {{}, &c, f}; }
+} inline emit;
+
+struct istream_yaml: ctom::istream_base{
+    typedef yaml::context context;
+    context* ctx = NULL;
+    document* doc = NULL;
+    istream_yaml operator()(context& c) const { return {{}, &c, NULL}; }
+    istream_yaml operator()(document& d) const { return {{}, NULL, &d}; }
+    istream_yaml operator()(context& c, document& d) const { return {{}, &c, &d}; }
+} inline parse;
 
-    std::string to_string(){
-        std::string str = "";
-        for(auto& s: state){
-            if(s == TAB) str = str+"  ";
-            if(s == DASH) str = str+"- ";
-        }
-        return str;
-    }
-};
+using ostream = ctom::ostream<ostream_yaml>;
+using istream = ctom::istream<istream_yaml>;
+
+inline ostream operator<<(std::ostream& os, ostream_yaml const& m) {
+    return ostream(os, (m.ctx != NULL) ? *m.ctx : ctom::local<context>(), m.fmt);
+}
 
-indent operator+(indent ind, indentstate state){
-    ind.state.push_back(state);
-    return ind;
+inline istream operator>>(std::istream& is, istream_yaml const& m) {
+    auto& ctx = (m.ctx != NULL) ? *m.ctx : ctom::local<context>();
+    ctx.target = m.doc;
+    return istream(is, ctx);
 }
 
 // Reference State
 
 template<typename T>
 struct set {
-    indent ind;
+    size_t depth;
     const char* key;
     T* t;
 };
 
+// Flow-Collection State
+
+template<typename T>
+struct flow {
+    T* t;
+};
+
 template<typename T>
 ostream operator<<(ostream const& os, T& type){
-    typename rule<T>::type ref(type);
-    return os << set{{}, NULL, &ref};
+    bind<T> ref(type);
+    CTOM_TRACE1(emit_begin, "yaml");
+    if(os.fmt == COMPACT){
+        os << flow{&ref.impl};
+        os.os << "\n";
+    }
+    else os << set{0, NULL, &ref.impl};
+    CTOM_TRACE1(emit_end, "yaml");
+    return os;
+}
+
+// Parse of the Root Node (Traced)
+
+template<typename T>
+void parse_root(istream& is, T& impl){
+    CTOM_TRACE2(parse_begin, "yaml", is.ctx.text.size());
+    try {
+        is >> set{0, NULL, &impl};
+    } catch(exception e){
+        CTOM_TRACE4(parse_error, "yaml", trace::offset(is.ctx), is.ctx.line, e.what());
+        throw;
+    }
+    CTOM_TRACE3(parse_end, "yaml", is.ctx.text.size(), is.ctx.line);
 }
 
 template<typename T>
 void operator>>(istream is, T& type){
-    typename rule<T>::type ref(type);
-    is >> set{{}, NULL, &ref};
+    bind<T> ref(type);
+    ctom::read(is.is, is.ctx);
+    parse_root(is, ref.impl);
+}
+
+// Parse into a new document handle, which owns all string views of type
+
+template<typename T>
+document load(std::istream& is, T& type){
+    document doc;
+    is >> parse(doc) >> type;
+    return doc;
+}
+
+// Parse a text in place: it is not copied into the context,
+//  so it only has to outlive the call.
+
+template<typename T>
+void parse_text(std::string_view text, T& type, context& ctx = ctom::local<context>()){
+    static thread_local std::istream none(NULL);
+    bind<T> ref(type);
+    ctx.target = NULL;
+    ctx.text = text;
+    ctx.src = text;
+    ctx.line = 0;
+    istream is(none, ctx);
+    parse_root(is, ref.impl);
 }
 
 /*
@@ -87,18 +147,84 @@ void operator>>(istream is, T& type){
 ================================================================================
 */
 
+// Indentation Prefix
+//  Writing a prefix consumes its dashes, they only apply to the first line.
+
+inline void put_indent(ostream const& os, size_t depth){
+    for(size_t d = 0; d < depth; d++){
+        if(os.ctx.ind[d] == TAB) os.os.write("  ", 2);
+        if(os.ctx.ind[d] == DASH) os.os.write("- ", 2);
+        os.ctx.ind[d] = TAB;
+    }
+}
+
+// Strings are written plain when they read back unchanged, else double-quoted.
+//  Flow collections additionally reserve their indicators.
+
+inline bool plain(std::string_view s, bool flow){
+    if(s.empty() || s == "~" || s == "null")
+        return false;
+    if(s.front() == ' ' || s.back() == ' ')
+        return false;
+    if(std::string_view("-?:,[]{}#&*!|>'\"%@`").find(s.front()) != std::string_view::npos)
+        return false;
+    auto end = s.data() + s.size();
+    if(flow) return escape::scan<true, '"', '\\', ':', '#', ',', '[', ']', '{', '}'>(s.data(), end) == end;
+    return escape::scan<true, '"', '\\', ':', '#'>(s.data(), end) == end;
+}
+
+inline void put_string(ostream const& os, std::string_view s, bool flow){
+    if(plain(s, flow)){
+        os.os.write(s.data(), s.size());
+        return;
+    }
+    os.os.put('"');
+    escape::put_escaped(os.os, s);
+    os.os.put('"');
+}
+
+// Scalar Values
+
+template<typename T>
+void put_val(ostream const& os, T& t, bool flow = false){
+    if constexpr(std::is_same_v<T, bool>)
+        os.os << (t ? "true" : "false");
+    else if constexpr(number_t<T>)
+        emit_number(os.os, t);
+    else if constexpr(std::is_convertible_v<T&, std::string_view>)
+        put_string(os, t, flow);
+    else if constexpr(std::is_same_v<T, char>)
+        put_string(os, std::string_view(&t, 1), flow);
+    else os.os << t;
+}
+
+// Value Nodes: Enums by Name
+
+template<val_t T>
+void put_node(ostream const& os, T& node, bool flow = false){
+    if constexpr(enum_t<T>){
+        auto name = T::name(*node.value);
+        auto num = +(typename T::U)*node.value;
+        if(name.empty()) put_val(os, num, flow);
+        else put_val(os, name, flow);
+    }
+    else put_val(os, *node.value, flow);
+}
+
 // Marshal Implementation
 
 template<val_t T>
 ostream operator<<(ostream const& os, set<T> s){
 
-    os.os << s.ind.to_string();
+    put_indent(os, s.depth);
 
-    if(s.key != NULL)
-        os.os << s.key << ": ";
+    if(s.key != NULL){
+        put_string(os, s.key, false);
+        os.os << ": ";
+    }
     
     if(s.t != NULL) 
-        os.os << *(s.t->value);
+        put_node(os, *s.t);
     else os.os << "null";
     
     os.os << "\n";
@@ -111,20 +237,19 @@ ostream operator<<(ostream const& os, set<T> s){
 
     if(s.key != NULL){
 
-        os.os << s.ind.to_string() << s.key << ":";
+        put_indent(os, s.depth);
+        put_string(os, s.key, false);
+        os.os << ":";
         if(s.t == NULL) os.os << " null";
         os.os << "\n";
 
-        for(auto& st: s.ind.state)
-            st = TAB;
-        s.ind = s.ind + TAB;
+        os.ctx.at(s.depth++) = TAB;
     }
 
     if(s.t != NULL)
     s.t->for_refs([&](auto&& ref){
-        os << set{s.ind + DASH, NULL, ref.node.impl};
-        for(auto& st: s.ind.state)
-            st = TAB;
+        os.ctx.at(s.depth) = DASH;
+        os << set{s.depth + 1, NULL, ref.node.impl};
     });
 
     return os;
@@ -135,24 +260,216 @@ ostream operator<<(ostream const& os, set<T> s){
 
     if(s.key != NULL){
 
-        os.os << s.ind.to_string() << s.key << ":";
+        put_indent(os, s.depth);
+        put_string(os, s.key, false);
+        os.os << ":";
         if(s.t == NULL) os.os << " null";
         os.os << "\n";
 
-        for(auto& st: s.ind.state)
-            st = TAB;
-        s.ind = s.ind + TAB;
+        os.ctx.at(s.depth++) = TAB;
     }
 
     if(s.t != NULL)
     s.t->for_refs([&](auto&& ref){
-        os << set{s.ind, ref.key, ref.node.impl};
-        for(auto& st: s.ind.state)
-            st = TAB;
+        os << set{s.depth, ref.key, ref.node.impl};
+    });
+
+    return os;
+
+}
+
+// Tagged Unions: the active alternative, tag first
+
+template<var_t T>
+ostream operator<<(ostream const& os, set<T> s){
+
+    if(s.key != NULL){
+
+        put_indent(os, s.depth);
+        put_string(os, s.key, false);
+        os.os << ":";
+        if(s.t == NULL) os.os << " null";
+        os.os << "\n";
+
+        os.ctx.at(s.depth++) = TAB;
+    }
+
+    if(s.t == NULL)
+        return os;
+
+    put_indent(os, s.depth);
+    put_string(os, T::tag, false);
+    os.os << ": ";
+    put_string(os, T::name(s.t->value->index()), false);
+    os.os << "\n";
+
+    std::visit([&](auto& alt){
+        bind<std::decay_t<decltype(alt)>> ref(alt);
+        os << set{s.depth, NULL, &ref.impl};
+    }, *s.t->value);
+
+    return os;
+
+}
+
+template<map_t T>
+ostream operator<<(ostream const& os, set<T> s){
+
+    if(s.key != NULL){
+
+        put_indent(os, s.depth);
+        put_string(os, s.key, false);
+        os.os << ":";
+        if(s.t == NULL) os.os << " null";
+        else if(s.t->value->empty()) os.os << " {}";
+        os.os << "\n";
+
+        os.ctx.at(s.depth++) = TAB;
+    }
+
+    else if(s.t != NULL && s.t->value->empty()){
+        put_indent(os, s.depth);
+        os.os << "{}\n";
+    }
+
+    if(s.t != NULL)
+    s.t->for_entries(os.ctx.order, [&](auto& entry){
+        bind<typename T::mapped_type> ref(entry.second);
+        os << set{s.depth, entry.first.c_str(), &ref.impl};
+    });
+
+    return os;
+
+}
+
+template<seq_t T>
+ostream operator<<(ostream const& os, set<T> s){
+
+    if(s.key != NULL){
+
+        put_indent(os, s.depth);
+        put_string(os, s.key, false);
+        os.os << ":";
+        if(s.t == NULL) os.os << " null";
+        else if(s.t->size() == 0) os.os << " []";
+        os.os << "\n";
+
+        os.ctx.at(s.depth++) = TAB;
+    }
+
+    else if(s.t != NULL && s.t->size() == 0){
+        put_indent(os, s.depth);
+        os.os << "[]\n";
+    }
+
+    if(s.t != NULL)
+    for(size_t n = 0; n < s.t->size(); n++){
+        os.ctx.at(s.depth) = DASH;
+        os << set{s.depth + 1, NULL, &s.t->at(n)};
+    }
+
+    return os;
+
+}
+
+// Compact Marshal Implementation: Flow Collections
+
+template<val_t T>
+ostream operator<<(ostream const& os, flow<T> f){
+    if(f.t != NULL) put_node(os, *f.t, true);
+    else os.os << "null";
+    return os;
+}
+
+template<arr_t T>
+ostream operator<<(ostream const& os, flow<T> f){
+    if(f.t == NULL){
+        os.os << "null";
+        return os;
+    }
+    os.os << "[";
+    size_t n = 0;
+    f.t->for_refs([&](auto&& ref){
+        if(n++ > 0) os.os << ",";
+        os << flow{ref.node.impl};
+    });
+    os.os << "]";
+    return os;
+}
+
+template<obj_t T>
+ostream operator<<(ostream const& os, flow<T> f){
+    if(f.t == NULL){
+        os.os << "null";
+        return os;
+    }
+    os.os << "{";
+    size_t n = 0;
+    f.t->for_refs([&](auto&& ref){
+        if(n++ > 0) os.os << ",";
+        put_string(os, std::string_view(ref.key), true);
+        os.os << ": ";
+        os << flow{ref.node.impl};
     });
+    os.os << "}";
+    return os;
+}
 
+template<var_t T>
+ostream operator<<(ostream const& os, flow<T> f){
+    if(f.t == NULL){
+        os.os << "null";
+        return os;
+    }
+    os.os << "{";
+    put_string(os, T::tag, true);
+    os.os << ": ";
+    put_string(os, T::name(f.t->value->index()), true);
+    std::visit([&](auto& alt){
+        bind<std::decay_t<decltype(alt)>> ref(alt);
+        ref.impl.for_refs([&](auto&& r){
+            os.os << ",";
+            put_string(os, std::string_view(r.key), true);
+            os.os << ": ";
+            os << flow{r.node.impl};
+        });
+    }, *f.t->value);
+    os.os << "}";
     return os;
+}
 
+template<map_t T>
+ostream operator<<(ostream const& os, flow<T> f){
+    if(f.t == NULL){
+        os.os << "null";
+        return os;
+    }
+    os.os << "{";
+    size_t n = 0;
+    f.t->for_entries(os.ctx.order, [&](auto& entry){
+        if(n++ > 0) os.os << ",";
+        bind<typename T::mapped_type> ref(entry.second);
+        put_string(os, entry.first, true);
+        os.os << ": ";
+        os << flow{&ref.impl};
+    });
+    os.os << "}";
+    return os;
+}
+
+template<seq_t T>
+ostream operator<<(ostream const& os, flow<T> f){
+    if(f.t == NULL){
+        os.os << "null";
+        return os;
+    }
+    os.os << "[";
+    for(size_t n = 0; n < f.t->size(); n++){
+        if(n > 0) os.os << ",";
+        os << flow{&f.t->at(n)};
+    }
+    os.os << "]";
+    return os;
 }
 
 /*
@@ -163,26 +480,26 @@ ostream operator<<(ostream const& os, set<T> s){
 
 // Base Trim Operations
 
-std::string_view pre_delim(std::string_view sv, std::string_view delim){
+inline std::string_view pre_delim(std::string_view sv, std::string_view delim){
     if(sv.find(delim) != std::string_view::npos)
         sv = sv.substr(0, sv.find(delim));
     return sv;
 }
 
-void trim_prefix(std::string_view& sv, std::string_view prefix){
+inline void trim_prefix(std::string_view& sv, std::string_view prefix){
     if(!sv.starts_with(prefix))
         throw parse_exception("failed to trim prefix");
     sv.remove_prefix(prefix.size());
 }
 
-void trim_delim(std::string_view& sv, std::string_view delim){
+inline void trim_delim(std::string_view& sv, std::string_view delim){
     if(sv.starts_with(delim) && sv.ends_with(delim)){
         sv.remove_prefix(delim.size());
         sv.remove_suffix(delim.size());
     }
 }
 
-void trim_whitespace(std::string_view& line){
+inline void trim_whitespace(std::string_view& line){
     if(line.find_first_not_of(" \t") == std::string_view::npos)
         line.remove_prefix(line.size());
     if(line.find_first_not_of(" \t") != std::string_view::npos)
@@ -191,96 +508,418 @@ void trim_whitespace(std::string_view& line){
         line.remove_suffix(line.size()-line.find_last_not_of(" \t")-1);
 }
 
-// Value-Parser
+// Comments start at a '#' after whitespace, outside of quoted scalars.
+//  Quotes only open at the start of a token, so "don't" stays plain.
+
+inline std::string_view strip_comment(std::string_view line){
+    char quote = 0;
+    auto begin = line.data();
+    auto end = begin + line.size();
+    for(auto p = begin; (p = escape::scan<false, '#', '"', '\''>(p, end)) != end; p++){
+        char prev = (p == begin) ? ' ' : p[-1];
+        if(quote != 0){
+            size_t escapes = 0;
+            if(quote == '"')
+                for(auto q = p; q != begin && q[-1] == '\\'; q--) escapes++;
+            if(quote == '\'' && p + 1 != end && p[1] == '\'')
+                p++;
+            else if(*p == quote && escapes % 2 == 0)
+                quote = 0;
+        }
+        else if(*p == '#'){
+            if(prev == ' ' || prev == '\t')
+                return line.substr(0, p - begin);
+        }
+        else if(std::string_view(" \t[{,:").find(prev) != std::string_view::npos)
+            quote = *p;
+    }
+    return line;
+}
 
-template<typename T>
-void parse_val(T& t, std::string_view v){
-    auto val = std::from_chars(v.data(), v.data() + v.size(), t);
-    if(val.ec == std::errc::invalid_argument)
-        throw parse_exception("invalid argument");
+// Stream Base-Operations
+
+inline bool next_line(istream& ifs, std::string_view& view){
+    auto& ctx = ifs.ctx;
+    while(!ctx.src.empty()){
+
+        auto end = ctx.src.find('\n');
+        auto line = ctx.src.substr(0, end);
+        ctx.src.remove_prefix((end == std::string_view::npos) ? ctx.src.size() : end + 1);
+        ctx.line++;
+
+        if(line.ends_with('\r'))
+            line.remove_suffix(1);
+
+        view = strip_comment(line);
+        if(view.find_first_not_of(" \t") != std::string_view::npos)
+            return true;
+
+    }
+    return false;
 }
 
-template<>
-void parse_val<char>(char& t, std::string_view v){
-    if(v.size() != 1)
-        throw parse_exception("invalid size for char");
-    t = v[0];
+inline std::string_view get_line(istream& ifs){
+    std::string_view view;
+    if(!next_line(ifs, view))
+        throw exception(ifs.ctx.line, "unexpected eof");
+    return view;
 }
 
-template<>
-void parse_val<std::string>(std::string& t, std::string_view v){
-    t = v;
+// Trim the expected indentation prefix, consuming its dashes
+
+inline void trim_indent(istream& ifs, std::string_view& line, size_t depth){
+    try {
+        for(size_t d = 0; d < depth; d++){
+            trim_prefix(line, (ifs.ctx.ind[d] == DASH) ? "- " : "  ");
+            ifs.ctx.ind[d] = TAB;
+        }
+        if(line.find_first_not_of(" \t") != 0)
+            throw parse_exception("overindented");
+    } catch(parse_exception e){
+        throw exception(ifs.ctx.line, std::string("invalid indent: ") + e.what());
+    }
 }
 
-// Stream Base-Operations
+// Quoted Scalars: double-quoted resolve their escapes, single-quoted their ''
 
-std::string_view get_line(istream& ifs){
-    while(!ifs.is.eof()){
+inline std::string_view unquote(istream& ifs, std::string_view val){
 
-        std::getline(ifs.is, ifs.cur);
-        ifs.line++;
+    if(val.size() < 2 || val.front() != val.back())
+        return val;
 
-        auto view = pre_delim(ifs.cur, "#");
-        if(view.find_first_not_of(" \t") != std::string_view::npos)
-            return view;
+    if(val.front() == '"')
+        return escape::resolve(val.substr(1, val.size() - 2), ifs.ctx.esc);
 
+    if(val.front() == '\''){
+        val = val.substr(1, val.size() - 2);
+        if(val.find("''") == std::string_view::npos)
+            return val;
+        auto& out = ifs.ctx.esc;
+        out.clear();
+        for(size_t n = 0; n < val.size(); n++){
+            out += val[n];
+            if(val[n] == '\'') n++;
+        }
+        return out;
     }
-    throw exception(ifs.line, "unexpected eof");
+
+    return val;
+
 }
 
-std::string_view get_key(std::string_view line){
-    if(line.find(":") == std::string_view::npos)
+// Key Separator: the first ':' after a (possibly quoted) key
+
+inline size_t key_sep(std::string_view line){
+    size_t n = 0;
+    if(line.starts_with('"') || line.starts_with('\'')){
+        for(n = 1; n < line.size() && line[n] != line[0]; n++)
+            if(line[0] == '"' && line[n] == '\\') n++;
+    }
+    return line.find(':', n);
+}
+
+inline std::string_view get_key(istream& ifs, std::string_view line){
+    auto sep = key_sep(line);
+    if(sep == std::string_view::npos)
         return "";
-    auto key = line.substr(0, line.find(":"));
+    auto key = line.substr(0, sep);
     trim_whitespace(key);
-    trim_delim(key, "\"");
-    return key;
+    try {
+        return unquote(ifs, key);
+    } catch(parse_exception e){
+        throw exception(ifs.ctx.line, std::string("invalid key: ") + e.what());
+    }
 }
 
-std::string_view get_val(std::string_view line){
-    std::string_view val;
-    if(line.find(":") == std::string_view::npos)
-        val = line.substr(0, line.find(":"));
-    else 
-        val = line.substr(line.find(":")+1);
+// Raw value, quotes are kept until the key is validated
+
+inline std::string_view get_val(std::string_view line){
+    auto sep = key_sep(line);
+    std::string_view val = (sep == std::string_view::npos) ? line : line.substr(sep + 1);
     trim_whitespace(val);
-    trim_delim(val, "\"");
     return val;
 }
 
+// Check (w.o. consuming) that a line is indented at exactly this depth
+
+inline bool match_indent(istream& ifs, std::string_view& line, size_t depth){
+    for(size_t d = 0; d < depth; d++){
+        if(!line.starts_with((ifs.ctx.ind[d] == DASH) ? "- " : "  "))
+            return false;
+        line.remove_prefix(2);
+    }
+    return line.find_first_not_of(" \t") == 0;
+}
+
+// Peek the key of the next line, if it is a key at exactly this depth
+
+inline bool peek_key(istream& ifs, size_t depth, std::string_view& key){
+
+    auto src = ifs.ctx.src;
+    auto line_n = ifs.ctx.line;
+
+    std::string_view line;
+    bool found = next_line(ifs, line);
+    ifs.ctx.src = src;
+    ifs.ctx.line = line_n;
+    if(!found || !match_indent(ifs, line, depth))
+        return false;
+
+    key = get_key(ifs, line);
+    return key != "";
+
+}
+
+// Check (w.o. consuming) that the next line is a sequence item at depth
+
+inline bool peek_item(istream& ifs, size_t depth){
+
+    auto src = ifs.ctx.src;
+    auto line_n = ifs.ctx.line;
+
+    std::string_view line;
+    bool found = next_line(ifs, line);
+    ifs.ctx.src = src;
+    ifs.ctx.line = line_n;
+    if(!found)
+        return false;
+
+    for(size_t d = 0; d < depth; d++){
+        if(!line.starts_with((ifs.ctx.ind[d] == DASH) ? "- " : "  "))
+            return false;
+        line.remove_prefix(2);
+    }
+    return line.starts_with("- ");
+
+}
+
+// Flow-Collection Base-Operations
+//  Flow collections are parsed directly from the document buffer,
+//  so they may span multiple lines.
+
+inline void flow_whitespace(istream& ifs){
+    auto& src = ifs.ctx.src;
+    while(!src.empty()){
+        char c = src.front();
+        if(c == '#'){
+            auto end = src.find('\n');
+            src.remove_prefix((end == std::string_view::npos) ? src.size() : end);
+            continue;
+        }
+        if(c == '\n') ifs.ctx.line++;
+        else if(c != ' ' && c != '\t' && c != '\r') return;
+        src.remove_prefix(1);
+    }
+}
+
+inline char flow_peek(istream& ifs){
+    flow_whitespace(ifs);
+    if(ifs.ctx.src.empty())
+        throw exception(ifs.ctx.line, "unexpected eof");
+    return ifs.ctx.src.front();
+}
+
+inline void flow_expect(istream& ifs, char c){
+    if(flow_peek(ifs) != c)
+        throw exception(ifs.ctx.line, std::string("expected '") + c + "', have '" + ifs.ctx.src.front() + "'");
+    ifs.ctx.src.remove_prefix(1);
+}
+
+// Consume a separator (true) or the closing bracket (false)
+
+inline bool flow_next(istream& ifs, char close){
+    char c = flow_peek(ifs);
+    if(c != ',' && c != close)
+        throw exception(ifs.ctx.line, std::string("expected ',' or '") + close + "', have '" + c + "'");
+    ifs.ctx.src.remove_prefix(1);
+    return c == ',';
+}
+
+// Quoted or Plain Scalar, Plain Scalars end at Flow Indicators.
+// Quoted scalars are returned with their quotes and escapes resolved.
+
+inline std::string_view flow_scalar(istream& ifs, bool& quoted){
+
+    char q = flow_peek(ifs);
+    quoted = (q == '"' || q == '\'');
+    auto& src = ifs.ctx.src;
+
+    if(quoted){
+        size_t n = 0;
+        while(true){
+            n = src.find_first_of((q == '"') ? "\"\\\n" : "'\n", n + 1);
+            if(n == std::string_view::npos || src[n] == '\n')
+                throw exception(ifs.ctx.line, "unterminated string");
+            if(src[n] == q && (q == '"' || n + 1 == src.size() || src[n + 1] != '\''))
+                break;
+            n++;
+        }
+        auto str = src.substr(0, n + 1);
+        src.remove_prefix(n + 1);
+        try {
+            return unquote(ifs, str);
+        } catch(parse_exception e){
+            throw exception(ifs.ctx.line, std::string("invalid string: ") + e.what());
+        }
+    }
+
+    size_t n = 0;
+    for(; n < src.size(); n++){
+        char c = src[n];
+        if(c == ',' || c == '[' || c == ']' || c == '{' || c == '}' || c == '\n' || c == '\r')
+            break;
+        if(c == ':' && (n + 1 == src.size() || std::string_view(" \t\r\n,[]{}").find(src[n + 1]) != std::string_view::npos))
+            break;
+        if(c == '#' && n > 0 && (src[n - 1] == ' ' || src[n - 1] == '\t'))
+            break;
+    }
+
+    auto str = src.substr(0, n);
+    src.remove_prefix(n);
+    trim_whitespace(str);
+    return str;
+
+}
+
+// Plain null in place of a collection
+
+inline bool flow_null(istream& ifs){
+    char c = flow_peek(ifs);
+    if(c == '[' || c == '{')
+        return false;
+    bool quoted;
+    auto val = flow_scalar(ifs, quoted);
+    if(!quoted && (val == "" || val == "~" || val == "null"))
+        return true;
+    throw exception(ifs.ctx.line, std::string("expected flow collection, have \"") + std::string(val) + "\"");
+}
+
+// Fast Flow Skipping: Bracket Depth Only
+
+inline void skip_flow(istream& ifs){
+    bool quoted;
+    size_t depth = 0;
+    do {
+        char c = flow_peek(ifs);
+        if(c == '[' || c == '{') depth++;
+        else if(c == ']' || c == '}') depth--;
+        else if(c != ',' && c != ':'){
+            flow_scalar(ifs, quoted);
+            continue;
+        }
+        ifs.ctx.src.remove_prefix(1);
+    } while(depth > 0);
+}
+
+// Enter a flow collection from a block line (key-value or at depth)
+
+inline bool begin_flow(istream& ifs, std::string_view val){
+    if(!val.starts_with('[') && !val.starts_with('{'))
+        return false;
+    auto end = ifs.ctx.src.data() + ifs.ctx.src.size();
+    ifs.ctx.src = std::string_view(val.data(), end - val.data());
+    return true;
+}
+
+inline bool peek_flow(istream& ifs, size_t depth){
+
+    auto src = ifs.ctx.src;
+    auto line_n = ifs.ctx.line;
+
+    std::string_view line;
+    if(next_line(ifs, line)){
+        auto view = line;
+        if(match_indent(ifs, view, depth) && (view.starts_with('[') || view.starts_with('{'))){
+            trim_indent(ifs, line, depth);
+            return begin_flow(ifs, line);
+        }
+    }
+
+    ifs.ctx.src = src;
+    ifs.ctx.line = line_n;
+    return false;
+
+}
+
+// Leave a flow collection: only a comment may follow on its last line
+
+inline void end_flow(istream& ifs){
+    auto& src = ifs.ctx.src;
+    auto end = src.find('\n');
+    auto rest = pre_delim(src.substr(0, end), "#");
+    if(rest.find_first_not_of(" \t\r") != std::string_view::npos)
+        throw exception(ifs.ctx.line, "unexpected content after flow collection");
+    src.remove_prefix((end == std::string_view::npos) ? src.size() : end + 1);
+}
+
+// Fast Subtree Skipping
+//  Consumes the current line and every following line nested below column,
+//  by indentation only: no value conversion, no allocation.
+
+inline void skip_lines(istream& ifs, size_t depth, size_t column){
+
+    auto line = get_line(ifs);
+    trim_indent(ifs, line, depth);
+
+    while(true){
+
+        auto src = ifs.ctx.src;
+        auto line_n = ifs.ctx.line;
+
+        std::string_view next;
+        if(!next_line(ifs, next))
+            return;
+
+        auto indent = next.find_first_not_of(' ');
+        if(indent > column || (indent == column && next.substr(indent).starts_with("- ")))
+            continue;
+
+        ifs.ctx.src = src;
+        ifs.ctx.line = line_n;
+        return;
+
+    }
+
+}
+
+// Skip a key and its value at depth
+
+inline void skip_key(istream& ifs, size_t depth){
+    skip_lines(ifs, depth, 2*depth);
+}
+
+// Skip a sequence item at depth (dash at depth-1)
+
+inline void skip_item(istream& ifs, size_t depth){
+    skip_lines(ifs, depth, 2*depth - 1);
+}
+
 template<val_t T>
 void operator>>(istream& stream, set<T> s){
 
     // Extract Line (w. Shift Pointer)
 
     auto line = get_line(stream);
-
-    try {
-        trim_prefix(line, s.ind.to_string());
-        if(line.find_first_not_of(" \t") != 0)
-            throw parse_exception("overindented");
-    } catch(parse_exception e){
-        throw exception(stream.line, std::string("invalid indent: ") + e.what());
-    }
+    trim_indent(stream, line, s.depth);
 
     // Extract Key, Value; Validate
 
-    auto key = get_key(line);
+    auto key = get_key(stream, line);
     auto val = get_val(line);
 
     if(s.key == NULL && key != "")
-        throw exception(stream.line, std::string("invalid key: want null, have \"") + std::string(key) + "\n");
+        throw exception(stream.ctx.line, std::string("invalid key: want null, have \"") + std::string(key) + "\n");
 
     if(s.key != NULL && key != s.key)
-        throw exception(stream.line, std::string("invalid key: want \"")+std::string(s.key)+"\", have \""+std::string(key)+"\"");
+        throw exception(stream.ctx.line, std::string("invalid key: want \"")+std::string(s.key)+"\", have \""+std::string(key)+"\"");
 
     // Validate, Parse
 
     if(s.t != NULL && val != "")
     try {
-        parse_val(*s.t->value, val);
+        parse_node(*s.t, unquote(stream, val), stream.ctx);
     } catch(parse_exception e){
-        throw exception(stream.line, std::string("failed to parse value: ") + e.what());
+        throw exception(stream.ctx.line, std::string("failed to parse value: ") + e.what());
     }
 
 }
@@ -293,90 +932,595 @@ void operator>>(istream& stream, set<T> s){
         // Extract Line (w. Shift Pointer)
 
         auto line = get_line(stream);
-
-        try {
-            trim_prefix(line, s.ind.to_string());
-            if(line.find_first_not_of(" \t") != 0)
-                throw parse_exception("overindented");
-        } catch(parse_exception e){
-            throw exception(stream.line, std::string("invalid indent: ") + e.what());
-        }
+        trim_indent(stream, line, s.depth);
 
        // Extract Key, Value
 
-        auto key = get_key(line);
+        auto key = get_key(stream, line);
         auto val = get_val(line);
 
         // Validate, Parse
 
         if(key != "" && key != s.key)
-            throw exception(stream.line, std::string("invalid key: want \"")+std::string(s.key)+"\", have \""+std::string(key)+"\"");
+            throw exception(stream.ctx.line, std::string("invalid key: want \"")+std::string(s.key)+"\", have \""+std::string(key)+"\"");
+
+        if(begin_flow(stream, val)){
+            stream >> flow{s.t};
+            end_flow(stream);
+            return;
+        }
 
         if(val != "")
-            throw exception(stream.line, std::string("unexpected value"));
+            throw exception(stream.ctx.line, std::string("unexpected value"));
 
         // Update Subsequent Expected Indentation State
 
-        for(auto& st: s.ind.state)
-            st = TAB;
-        s.ind = s.ind + TAB;
+        stream.ctx.at(s.depth++) = TAB;
 
     }
 
+    else if(peek_flow(stream, s.depth)){
+        stream >> flow{s.t};
+        end_flow(stream);
+        return;
+    }
+
     if(s.t != NULL)
     s.t->for_refs([&](auto&& ref){
-        stream >> set{s.ind + DASH, NULL, ref.node.impl};
-        for(auto& st: s.ind.state)
-            st = TAB;
+        stream.ctx.at(s.depth) = DASH;
+        if(ref.node.impl == NULL)
+            skip_item(stream, s.depth + 1);
+        else stream >> set{s.depth + 1, NULL, ref.node.impl};
     });
 
 }
 
+// Members in any order, dispatched by key;
+//  unknown or unbound members and the member named skip (a tag) are skipped.
+//  The keys found are marked in seen.
+
+template<obj_t T>
+void parse_members(istream& stream, set<T> s, std::string_view skip, std::bitset<T::size>& seen){
+
+    std::string_view key;
+    while(peek_key(stream, s.depth, key)){
+
+        if(!skip.empty() && key == skip){
+            skip_key(stream, s.depth);
+            continue;
+        }
+
+        bool found = false;
+        size_t n = 0;
+        if(s.t != NULL)
+        s.t->for_refs([&](auto&& ref){
+            if(found || key != std::string_view(ref.key)){
+                n++;
+                return;
+            }
+            found = true;
+            seen.set(n);
+            if(ref.node.impl == NULL)
+                skip_key(stream, s.depth);
+            else stream >> set{s.depth, ref.key, ref.node.impl};
+        });
+
+        if(found)
+            continue;
+
+        if(stream.ctx.strict){
+            get_line(stream);
+            throw exception(stream.ctx.line, std::string("unexpected key: \"") + std::string(key) + "\"");
+        }
+
+        skip_key(stream, s.depth);
+
+    }
+
+}
+
+// All bound keys of an object are required
+
+template<obj_t T>
+void parse_members(istream& stream, set<T> s, std::string_view skip = {}){
+    std::bitset<T::size> seen;
+    parse_members(stream, s, skip, seen);
+    if(s.t == NULL)
+        return;
+    if(auto key = s.t->missing(seen))
+        throw exception(stream.ctx.line, std::string("missing key: \"") + key + "\"");
+}
+
 template<obj_t T>
 void operator>>(istream& stream, set<T> s){
 
+    CTOM_TRACE_OBJECT("yaml", s.key, stream.ctx);
+
     // Extract Line (w. Shift Pointer)
 
     if(s.key != NULL){
 
         auto line = get_line(stream);
+        trim_indent(stream, line, s.depth);
 
-        try {
-            trim_prefix(line, s.ind.to_string());
-            if(line.find_first_not_of(" \t") != 0)
-                throw parse_exception("overindented");
-        } catch(parse_exception e){
-            throw exception(stream.line, std::string("invalid indent: ") + e.what());
+        // Extract Key, Value
+
+        auto key = get_key(stream, line);
+        auto val = get_val(line);
+
+        // Validate, Parse
+
+        if(key != "" && key != s.key)
+            throw exception(stream.ctx.line, std::string("invalid key: want \"")+std::string(s.key)+"\", have \""+std::string(key)+"\"");
+        
+        if(begin_flow(stream, val)){
+            stream >> flow{s.t};
+            end_flow(stream);
+            return;
+        }
+
+        if(val != "")
+            throw exception(stream.ctx.line, std::string("unexpected value"));
+
+        // Update Subsequent Expected Indentation State
+
+        stream.ctx.at(s.depth++) = TAB;
+
+    }
+
+    else if(peek_flow(stream, s.depth)){
+        stream >> flow{s.t};
+        end_flow(stream);
+        return;
+    }
+
+    parse_members(stream, s);
+
+}
+
+template<map_t T>
+void operator>>(istream& stream, set<T> s){
+
+    // Extract Line (w. Shift Pointer)
+
+    if(s.key != NULL){
+
+        auto line = get_line(stream);
+        trim_indent(stream, line, s.depth);
+
+        // Extract Key, Value
+
+        auto key = get_key(stream, line);
+        auto val = get_val(line);
+
+        // Validate, Parse
+
+        if(key != "" && key != s.key)
+            throw exception(stream.ctx.line, std::string("invalid key: want \"")+std::string(s.key)+"\", have \""+std::string(key)+"\"");
+
+        if(begin_flow(stream, val)){
+            stream >> flow{s.t};
+            end_flow(stream);
+            return;
         }
 
+        if(val != "")
+            throw exception(stream.ctx.line, std::string("unexpected value"));
+
+        // Update Subsequent Expected Indentation State
+
+        stream.ctx.at(s.depth++) = TAB;
+
+    }
+
+    else if(peek_flow(stream, s.depth)){
+        stream >> flow{s.t};
+        end_flow(stream);
+        return;
+    }
+
+    if(s.t == NULL)
+        return;
+
+    // Entries continue while lines hold a key at this depth
+
+    s.t->reserve();
+
+    std::string_view key;
+    while(peek_key(stream, s.depth, key)){
+        auto& entry = s.t->entry(key, stream.ctx.buf);
+        bind<typename T::mapped_type> ref(entry.second);
+        stream >> set{s.depth, entry.first.c_str(), &ref.impl};
+    }
+
+}
+
+template<seq_t T>
+void operator>>(istream& stream, set<T> s){
+
+    // Extract Line (w. Shift Pointer)
+
+    if(s.key != NULL){
+
+        auto line = get_line(stream);
+        trim_indent(stream, line, s.depth);
+
         // Extract Key, Value
 
-        auto key = get_key(line);
+        auto key = get_key(stream, line);
         auto val = get_val(line);
 
         // Validate, Parse
 
         if(key != "" && key != s.key)
-            throw exception(stream.line, std::string("invalid key: want \"")+std::string(s.key)+"\", have \""+std::string(key)+"\"");
-        
+            throw exception(stream.ctx.line, std::string("invalid key: want \"")+std::string(s.key)+"\", have \""+std::string(key)+"\"");
+
+        if(begin_flow(stream, val)){
+            stream >> flow{s.t};
+            end_flow(stream);
+            return;
+        }
+
         if(val != "")
-            throw exception(stream.line, std::string("unexpected value"));
+            throw exception(stream.ctx.line, std::string("unexpected value"));
 
         // Update Subsequent Expected Indentation State
 
-        for(auto& st: s.ind.state)
-            st = TAB;
-        s.ind = s.ind + TAB;
+        stream.ctx.at(s.depth++) = TAB;
+
+    }
+
+    else if(peek_flow(stream, s.depth)){
+        stream >> flow{s.t};
+        end_flow(stream);
+        return;
+    }
+
+    // Items continue while lines hold a dash at this depth
 
+    size_t n = 0;
+    while(peek_item(stream, s.depth)){
+        stream.ctx.at(s.depth) = DASH;
+        if(s.t == NULL)
+            skip_item(stream, s.depth + 1);
+        else stream >> set{s.depth + 1, NULL, &s.t->slot(n++)};
     }
 
     if(s.t != NULL)
-    s.t->for_refs([&](auto&& ref){
-        stream >> set{s.ind, ref.key, ref.node.impl};
-        for(auto& st: s.ind.state)
-            st = TAB;
+        s.t->trim(n);
+
+}
+
+// Tag of the block object ahead at depth, without consuming it:
+//  other members are skipped by indentation only.
+
+inline bool peek_tag(istream& ifs, size_t depth, std::string_view tag, std::string_view& val){
+
+    auto src = ifs.ctx.src;
+    auto line_n = ifs.ctx.line;
+
+    bool first = true;
+    bool found = false;
+    std::string_view line;
+    while(!found && next_line(ifs, line)){
+
+        auto view = line;
+        if(first){
+            if(!match_indent(ifs, view, depth))
+                break;
+            first = false;
+        } else {
+            auto indent = line.find_first_not_of(' ');
+            if(indent > 2*depth)
+                continue;
+            if(indent < 2*depth || line.substr(indent).starts_with("- "))
+                break;
+            view.remove_prefix(indent);
+        }
+
+        if(get_key(ifs, view) == tag){
+            val = unquote(ifs, get_val(view));
+            found = true;
+        }
+
+    }
+
+    ifs.ctx.src = src;
+    ifs.ctx.line = line_n;
+    return found;
+
+}
+
+// Alternative Parsers, Indexed by Tag
+
+template<var_t T>
+struct parse_alt {
+    template<size_t I>
+    static void call(istream& stream, set<T> s){
+        auto& alt = s.t->template get<I>();
+        bind<std::decay_t<decltype(alt)>> ref(alt);
+        parse_members(stream, set{s.depth, NULL, &ref.impl}, T::tag);
+    }
+};
+
+template<var_t T>
+struct flow_alt {
+    template<size_t I>
+    static void call(istream& stream, flow<T> f){
+        auto& alt = f.t->template get<I>();
+        bind<std::decay_t<decltype(alt)>> ref(alt);
+        flow_members(stream, flow{&ref.impl}, T::tag);
+    }
+};
+
+template<var_t T>
+void operator>>(istream& stream, set<T> s){
+
+    CTOM_TRACE_OBJECT("yaml", s.key, stream.ctx);
+
+    // Extract Line (w. Shift Pointer)
+
+    if(s.key != NULL){
+
+        auto line = get_line(stream);
+        trim_indent(stream, line, s.depth);
+
+        // Extract Key, Value
+
+        auto key = get_key(stream, line);
+        auto val = get_val(line);
+
+        // Validate, Parse
+
+        if(key != "" && key != s.key)
+            throw exception(stream.ctx.line, std::string("invalid key: want \"")+std::string(s.key)+"\", have \""+std::string(key)+"\"");
+
+        if(begin_flow(stream, val)){
+            stream >> flow{s.t};
+            end_flow(stream);
+            return;
+        }
+
+        if(val != "")
+            throw exception(stream.ctx.line, std::string("unexpected value"));
+
+        // Update Subsequent Expected Indentation State
+
+        stream.ctx.at(s.depth++) = TAB;
+
+    }
+
+    else if(peek_flow(stream, s.depth)){
+        stream >> flow{s.t};
+        end_flow(stream);
+        return;
+    }
+
+    if(s.t == NULL){
+        std::string_view key;
+        while(peek_key(stream, s.depth, key))
+            skip_key(stream, s.depth);
+        return;
+    }
+
+    // Discriminator First, then the Alternative's Members
+
+    std::string_view name;
+    if(!peek_tag(stream, s.depth, T::tag, name))
+        throw exception(stream.ctx.line + 1, std::string("missing tag: \"") + std::string(T::tag) + "\"");
+
+    size_t index = T::table.find(name);
+    if(index == T::N)
+        throw exception(stream.ctx.line + 1, std::string("unknown tag: \"") + std::string(name) + "\"");
+
+    static constexpr auto table = T::template dispatch<parse_alt<T>>();
+    table[index](stream, s);
+
+}
+
+// Flow Unmarshal Implementation
+
+template<val_t T>
+void operator>>(istream& stream, flow<T> f){
+
+    bool quoted;
+    auto val = flow_scalar(stream, quoted);
+
+    if(f.t == NULL || (!quoted && (val == "" || val == "~" || val == "null")))
+        return;
+
+    try {
+        parse_node(*f.t, val, stream.ctx);
+    } catch(parse_exception e){
+        throw exception(stream.ctx.line, std::string("failed to parse value: ") + e.what());
+    }
+
+}
+
+template<arr_t T>
+void operator>>(istream& stream, flow<T> f){
+
+    if(f.t == NULL)
+        return skip_flow(stream);
+
+    if(flow_null(stream))
+        return;
+
+    flow_expect(stream, '[');
+
+    size_t n = 0;
+    f.t->for_refs([&](auto&& ref){
+        if(n++ > 0) flow_expect(stream, ',');
+        stream >> flow{ref.node.impl};
     });
 
+    flow_expect(stream, ']');
+
+}
+
+// Flow Members in any order, dispatched by key;
+//  unknown members and the member named skip (a tag) are skipped.
+
+template<obj_t T>
+void flow_members(istream& stream, flow<T> f, std::string_view skip = {}){
+
+    std::bitset<T::size> seen;
+    flow_expect(stream, '{');
+    if(flow_peek(stream) == '}')
+        stream.ctx.src.remove_prefix(1);
+    else do {
+
+        bool quoted;
+        auto key = flow_scalar(stream, quoted);
+        flow_expect(stream, ':');
+
+        if(!skip.empty() && key == skip){
+            skip_flow(stream);
+            continue;
+        }
+
+        bool found = false;
+        size_t n = 0;
+        f.t->for_refs([&](auto&& ref){
+            if(found || key != std::string_view(ref.key)){
+                n++;
+                return;
+            }
+            found = true;
+            seen.set(n);
+            stream >> flow{ref.node.impl};
+        });
+
+        if(found)
+            continue;
+
+        if(stream.ctx.strict)
+            throw exception(stream.ctx.line, std::string("unexpected key: \"") + std::string(key) + "\"");
+
+        skip_flow(stream);
+
+    } while(flow_next(stream, '}'));
+
+    if(auto key = f.t->missing(seen))
+        throw exception(stream.ctx.line, std::string("missing key: \"") + key + "\"");
+
+}
+
+template<obj_t T>
+void operator>>(istream& stream, flow<T> f){
+
+    if(f.t == NULL)
+        return skip_flow(stream);
+
+    if(flow_null(stream))
+        return;
+
+    flow_members(stream, f);
+
+}
+
+template<map_t T>
+void operator>>(istream& stream, flow<T> f){
+
+    if(f.t == NULL)
+        return skip_flow(stream);
+
+    if(flow_null(stream))
+        return;
+
+    flow_expect(stream, '{');
+    if(flow_peek(stream) == '}'){
+        stream.ctx.src.remove_prefix(1);
+        return;
+    }
+
+    f.t->reserve();
+
+    do {
+
+        bool quoted;
+        auto key = flow_scalar(stream, quoted);
+        flow_expect(stream, ':');
+
+
+        auto& entry = f.t->entry(key, stream.ctx.buf);
+        bind<typename T::mapped_type> ref(entry.second);
+        stream >> flow{&ref.impl};
+
+    } while(flow_next(stream, '}'));
+
+}
+
+template<seq_t T>
+void operator>>(istream& stream, flow<T> f){
+
+    if(f.t == NULL)
+        return skip_flow(stream);
+
+    if(flow_null(stream))
+        return;
+
+    flow_expect(stream, '[');
+
+    size_t n = 0;
+    if(flow_peek(stream) == ']')
+        stream.ctx.src.remove_prefix(1);
+    else do {
+        stream >> flow{&f.t->slot(n++)};
+    } while(flow_next(stream, ']'));
+
+    f.t->trim(n);
+
+}
+
+// Tag of the flow object ahead, without consuming it
+
+inline bool flow_tag(istream& ifs, std::string_view tag, std::string_view& val){
+
+    auto src = ifs.ctx.src;
+    auto line_n = ifs.ctx.line;
+
+    bool found = false;
+    flow_expect(ifs, '{');
+    if(flow_peek(ifs) != '}')
+    do {
+        bool quoted;
+        auto key = flow_scalar(ifs, quoted);
+        flow_expect(ifs, ':');
+        if(key == tag){
+            val = flow_scalar(ifs, quoted);
+            found = true;
+            break;
+        }
+        skip_flow(ifs);
+    } while(flow_next(ifs, '}'));
+
+    ifs.ctx.src = src;
+    ifs.ctx.line = line_n;
+    return found;
+
+}
+
+template<var_t T>
+void operator>>(istream& stream, flow<T> f){
+
+    if(f.t == NULL)
+        return skip_flow(stream);
+
+    if(flow_null(stream))
+        return;
+
+    std::string_view name;
+    if(!flow_tag(stream, T::tag, name))
+        throw exception(stream.ctx.line, std::string("missing tag: \"") + std::string(T::tag) + "\"");
+
+    size_t index = T::table.find(name);
+    if(index == T::N)
+        throw exception(stream.ctx.line, std::string("unknown tag: \"") + std::string(name) + "\"");
+
+    static constexpr auto table = T::template dispatch<flow_alt<T>>();
+    table[index](stream, f);
+
 }
 
 }   // end of namespace yaml